@@ -1,10 +1,69 @@
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string_view>
 
 namespace bayeselo {
 
+// Plain duration for command-line values: seconds or a number with an h/m/s suffix ("300", "5m").
+// Anything after the number (e.g. "+2") is ignored. Throws std::invalid_argument.
 double parse_duration_to_seconds(std::string_view value);
 
+// One period of a PGN TimeControl: `moves` moves (0 = the rest of the game) in `seconds`, plus
+// `increment` seconds per move.
+struct TimeControlPeriod {
+    std::uint32_t moves{0};
+    double seconds{0.0};
+    double increment{0.0};
+};
+
+struct TimeControl {
+    static constexpr std::size_t kMaxPeriods = 4;
+
+    std::array<TimeControlPeriod, kMaxPeriods> periods{};
+    std::uint8_t period_count{0};
+    bool sandclock{false}; // "*60": periods[0].seconds for the whole game
+
+    // Clock time one side gets over a game of `plies` half-moves: the base time of every period it
+    // reaches plus the increment for each of its ceil(plies / 2) moves. A last period with a move
+    // count repeats.
+    double estimate_seconds(std::uint32_t plies) const;
+    // False when the estimate is the same for every game length (e.g. "300", "*60").
+    bool depends_on_plies() const;
+};
+
+enum class TimeControlError : std::uint8_t {
+    Unknown,   // "?"
+    Unlimited, // "-"
+    Malformed
+};
+
+// Result of parse_time_control, shaped like std::expected<TimeControl, TimeControlError>.
+class TimeControlResult {
+public:
+    TimeControlResult(TimeControl value) : value_(value), has_value_(true) {}
+    TimeControlResult(TimeControlError error) : error_(error) {}
+
+    bool has_value() const { return has_value_; }
+    explicit operator bool() const { return has_value_; }
+    const TimeControl& value() const { return value_; }
+    const TimeControl& operator*() const { return value_; }
+    const TimeControl* operator->() const { return &value_; }
+    TimeControlError error() const { return error_; }
+
+private:
+    TimeControl value_{};
+    TimeControlError error_{TimeControlError::Malformed};
+    bool has_value_{false};
+};
+
+// Parses a PGN TimeControl tag value (PGN standard 9.6.1): "?", "-", sandclock "*60", or up to
+// kMaxPeriods ':'-separated periods of "moves/seconds" or "seconds[+increment]", e.g.
+// "40/7200:3600" or "300+2". Numbers may carry an h/m/s suffix as some GUIs write ("3m+2").
+// Never throws or allocates.
+TimeControlResult parse_time_control(std::string_view value) noexcept;
+
 } // namespace bayeselo
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace bayeselo {
 
@@ -15,6 +16,10 @@ struct FilterConfig {
     std::optional<std::string> black_name;
     std::optional<std::string> either_name;
     std::optional<std::string> exclude_name;
+    // Substring lists (e.g. from --include-names-file): keep only games where either name contains
+    // one of include_names; drop games where either name contains one of exclude_names.
+    std::vector<std::string> include_names;
+    std::vector<std::string> exclude_names;
     std::optional<std::string> result_filter;
     std::optional<std::string> termination;
     bool require_complete{false};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "bayeselo/move_list.h"
+
 #include <string>
 #include <string_view>
 #include <vector>
@@ -29,9 +31,32 @@ struct GameMetadata {
 struct Game {
     GameMetadata meta;
     GameResult result;
-    std::vector<std::string> moves;
+    MoveList moves;
+    std::uint32_t ply_count{0};
+    std::optional<double> estimated_duration_seconds;
+};
+
+// Id of an absent tag value in GameView's tag dictionary ids.
+inline constexpr std::uint32_t kNoTagId = 0xffffffffu;
+
+// Non-owning view of a parsed game. The strings point into the buffer the game was parsed from
+// (see ParsedChunk), so producing one allocates nothing; convert to Game to keep it past the chunk.
+struct GameView {
+    std::string_view white;
+    std::string_view black;
+    std::optional<std::string_view> utc_date;
+    std::optional<std::string_view> utc_time;
+    std::optional<std::string_view> time_control;
+    std::optional<std::string_view> termination;
+    GameResult::Outcome outcome{GameResult::Outcome::Unknown};
     std::uint32_t ply_count{0};
     std::optional<double> estimated_duration_seconds;
+    // Ids into the parsing chunk's dictionaries (ParsedChunk::players / time_controls /
+    // terminations); kNoTagId when the tag is absent or the view was not built by a chunk parser.
+    std::uint32_t white_id{kNoTagId};
+    std::uint32_t black_id{kNoTagId};
+    std::uint32_t time_control_id{kNoTagId};
+    std::uint32_t termination_id{kNoTagId};
 };
 
 struct PlayerStats {
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bayeselo {
+
+// Moves are stored packed: the SAN tokens back to back in one buffer, and ends[i] the end offset
+// of token i (token i starts where token i - 1 ends). A game's moves take two allocations instead
+// of one string per move.
+
+// Random-access iterator yielding the tokens of a packed move list as string_views.
+class MoveIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::string_view;
+
+    MoveIterator() = default;
+    MoveIterator(const char* text, const std::uint32_t* ends, std::size_t index) : text_(text), ends_(ends), index_(index) {}
+
+    std::string_view operator*() const { return (*this)[0]; }
+    std::string_view operator[](difference_type n) const {
+        const std::size_t i = index_ + static_cast<std::size_t>(n);
+        const std::uint32_t begin = i == 0 ? 0 : ends_[i - 1];
+        return std::string_view(text_ + begin, ends_[i] - begin);
+    }
+    MoveIterator& operator++() { ++index_; return *this; }
+    MoveIterator operator++(int) { auto copy = *this; ++index_; return copy; }
+    MoveIterator& operator--() { --index_; return *this; }
+    MoveIterator operator--(int) { auto copy = *this; --index_; return copy; }
+    MoveIterator& operator+=(difference_type n) { index_ += static_cast<std::size_t>(n); return *this; }
+    MoveIterator& operator-=(difference_type n) { index_ -= static_cast<std::size_t>(n); return *this; }
+    friend MoveIterator operator+(MoveIterator it, difference_type n) { return it += n; }
+    friend MoveIterator operator+(difference_type n, MoveIterator it) { return it += n; }
+    friend MoveIterator operator-(MoveIterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const MoveIterator& a, const MoveIterator& b) {
+        return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+    }
+    friend bool operator==(const MoveIterator& a, const MoveIterator& b) { return a.index_ == b.index_; }
+    friend bool operator!=(const MoveIterator& a, const MoveIterator& b) { return a.index_ != b.index_; }
+    friend bool operator<(const MoveIterator& a, const MoveIterator& b) { return a.index_ < b.index_; }
+    friend bool operator>(const MoveIterator& a, const MoveIterator& b) { return a.index_ > b.index_; }
+    friend bool operator<=(const MoveIterator& a, const MoveIterator& b) { return a.index_ <= b.index_; }
+    friend bool operator>=(const MoveIterator& a, const MoveIterator& b) { return a.index_ >= b.index_; }
+
+private:
+    const char* text_{nullptr};
+    const std::uint32_t* ends_{nullptr};
+    std::size_t index_{0};
+};
+
+// Non-owning view of one game's packed moves (e.g. inside a ParsedChunk); copy into a MoveList to
+// keep them past the buffer they point into.
+class MoveSpan {
+public:
+    MoveSpan() = default;
+    MoveSpan(std::string_view text, const std::uint32_t* ends, std::size_t count) : text_(text), ends_(ends), count_(count) {}
+
+    std::size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    std::string_view operator[](std::size_t i) const { return begin()[static_cast<std::ptrdiff_t>(i)]; }
+    std::string_view front() const { return (*this)[0]; }
+    std::string_view back() const { return (*this)[count_ - 1]; }
+    MoveIterator begin() const { return MoveIterator(text_.data(), ends_, 0); }
+    MoveIterator end() const { return MoveIterator(text_.data(), ends_, count_); }
+    // All tokens concatenated without separators.
+    std::string_view text() const { return text_; }
+    const std::uint32_t* ends() const { return ends_; }
+
+private:
+    std::string_view text_;
+    const std::uint32_t* ends_{nullptr};
+    std::size_t count_{0};
+};
+
+// Owning packed move list held by Game.
+class MoveList {
+public:
+    MoveList() = default;
+    explicit MoveList(MoveSpan span) : text_(span.text()), ends_(span.ends(), span.ends() + span.size()) {}
+
+    void push_back(std::string_view token) {
+        text_.append(token);
+        ends_.push_back(static_cast<std::uint32_t>(text_.size()));
+    }
+    void reserve(std::size_t tokens, std::size_t bytes) {
+        ends_.reserve(tokens);
+        text_.reserve(bytes);
+    }
+    void clear() {
+        text_.clear();
+        ends_.clear();
+    }
+    void shrink_to_fit() {
+        text_.shrink_to_fit();
+        ends_.shrink_to_fit();
+    }
+
+    std::size_t size() const { return ends_.size(); }
+    bool empty() const { return ends_.empty(); }
+    std::size_t capacity() const { return ends_.capacity(); }
+    std::string_view operator[](std::size_t i) const { return span()[i]; }
+    std::string_view front() const { return span().front(); }
+    std::string_view back() const { return span().back(); }
+    MoveIterator begin() const { return span().begin(); }
+    MoveIterator end() const { return span().end(); }
+    MoveSpan span() const { return MoveSpan(text_, ends_.data(), ends_.size()); }
+    operator MoveSpan() const { return span(); }
+
+private:
+    std::string text_;
+    std::vector<std::uint32_t> ends_;
+};
+
+} // namespace bayeselo
@@ -7,19 +7,40 @@
 #include "output/export_writer.h"
 #include "output/terminal_output.h"
 #include "parser/chunk_splitter.h"
+#include "parser/game_cache.h"
+#include "parser/game_index.h"
+#include "parser/gzip_reader.h"
 #include "parser/pgn_parser.h"
+#include "parser/stream_reader.h"
 #include "rating/bayeselo_solver.h"
+#include "rating/ingest_state.h"
+#include "util/bounded_queue.h"
+#include "util/buffer_pool.h"
+#include "util/directory_walker.h"
+#include "util/file_watcher.h"
+#include "util/mapped_file.h"
 #include "util/thread_pool.h"
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <thread>
 #include <cctype>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -27,6 +48,7 @@ using namespace bayeselo;
 
 struct CliOptions {
     std::vector<std::filesystem::path> files;
+    std::vector<std::filesystem::path> dirs; // walked in parallel once parsing has started
     FilterConfig filters;
     std::optional<std::filesystem::path> csv;
     std::optional<std::filesystem::path> json;
@@ -35,6 +57,13 @@ struct CliOptions {
     bool keep_moves{false};
     std::optional<std::size_t> max_bytes;
     bool markdown{false};
+    IoBackend io_backend{IoBackend::Mmap};
+    std::optional<std::size_t> chunk_bytes;
+    std::optional<std::filesystem::path> cache_dir;
+    bool pgn_index{false};
+    std::optional<std::filesystem::path> state_file;
+    bool follow{false};
+    bool pin_threads{false};
     std::size_t planned_games{0};
     enum class OutputStyle { Auto, Fastchess, BayesElo };
     OutputStyle style{OutputStyle::Auto};
@@ -43,44 +72,94 @@ struct CliOptions {
 namespace {
 
 bool has_pgn_extension(const std::filesystem::path& path) {
-    auto ext = path.extension().string();
-    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    auto lowered_extension = [](const std::filesystem::path& p) {
+        auto ext = p.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext;
+    };
+    auto ext = lowered_extension(path);
+    if (ext == ".gz" || ext == ".bgz") {
+        ext = lowered_extension(path.stem()); // game.pgn.gz
+    }
     return ext == ".pgn";
 }
 
-void append_pgn_files_from_dir(const std::filesystem::path& dir, std::vector<std::filesystem::path>& target) {
+bool check_pgn_dir(const std::filesystem::path& dir) {
     std::error_code ec;
     if (!std::filesystem::exists(dir, ec)) {
         std::cerr << "Directory not found: " << dir << "\n";
-        return;
+        return false;
     }
     if (!std::filesystem::is_directory(dir, ec)) {
         std::cerr << "Not a directory: " << dir << "\n";
-        return;
+        return false;
     }
-    std::size_t added = 0;
-    std::filesystem::recursive_directory_iterator it(dir, ec), end;
-    if (ec) {
-        std::cerr << "Failed to scan directory " << dir << ": " << ec.message() << "\n";
-        return;
+    return true;
+}
+
+// Transparent hash so names can be looked up by string_view without building a std::string key.
+struct NameHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view name) const noexcept { return std::hash<std::string_view>{}(name); }
+};
+
+// "-" (stdin), pipes, FIFOs and character devices cannot be split by offset and are streamed.
+bool is_stream_input(const std::filesystem::path& path) {
+    if (path == "-") {
+        return true;
     }
-    for (; it != end; it.increment(ec)) {
-        if (ec) {
-            std::cerr << "Error while scanning " << dir << ": " << ec.message() << "\n";
-            break;
-        }
-        if (!it->is_regular_file()) {
-            continue;
-        }
-        if (!has_pgn_extension(it->path())) {
+    std::error_code ec;
+    const auto status = std::filesystem::status(path, ec);
+    return !ec && (status.type() == std::filesystem::file_type::fifo || status.type() == std::filesystem::file_type::character);
+}
+
+struct ChunkTask {
+    ChunkRange range;
+    std::shared_ptr<const MappedFile> mapping; // null when reading through the ifstream backend
+    std::shared_ptr<GameCacheWriter> cache;    // set when the file's games are being cached
+    std::shared_ptr<GameIndexWriter> index;    // set when the file's .pgnidx sidecar is being built
+    std::size_t range_index{0};
+    IngestedFile* tracked{nullptr}; // set for --state files; the chunk's results are recorded there
+    std::size_t input_order{0};     // InputFile::order of the file
+};
+
+struct InputFile {
+    std::filesystem::path path;
+    std::size_t size{0};
+    // Position on the command line, which decides merge order. Files found under a directory share
+    // the directory's position (directories count after all listed files) and merge by path.
+    std::size_t order{0};
+};
+
+// Reads a whole (small) file with one read; mapping a file this size costs more than copying it.
+bool read_whole_file(const InputFile& input, std::vector<char>& out) {
+    std::ifstream in(input.path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    out.resize(input.size);
+    in.read(out.data(), static_cast<std::streamsize>(out.size()));
+    out.resize(static_cast<std::size_t>(in.gcount()));
+    return !in.bad();
+}
+
+// One name substring per line; surrounding whitespace is trimmed, blank lines and lines starting
+// with '#' are skipped.
+bool read_name_patterns(const std::filesystem::path& file, std::vector<std::string>& out) {
+    std::ifstream in(file);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
             continue;
         }
-        target.push_back(it->path());
-        ++added;
-    }
-    if (added == 0) {
-        std::cerr << "No PGN files found under " << dir << "\n";
+        const auto last = line.find_last_not_of(" \t\r");
+        out.push_back(line.substr(first, last - first + 1));
     }
+    return !in.bad();
 }
 
 } // namespace
@@ -89,32 +168,42 @@ void print_help() {
     std::cout
         << "Bayesian Elo PGN rating tool\n"
         << "Inspired by BayesElo by Remi Coulom (http://www.remi-coulom.fr/Bayesian-Elo)\n"
-        << "Usage: elo_rating [options] file1.pgn file2.pgn ...\n\n"
+        << "Usage: elo_rating [options] file1.pgn file2.pgn ...  (use - to read PGN from stdin)\n\n"
         << "Options:\n"
         << "  -h, --help                  Show this help message and exit\n"
         << "  --version                   Print version information and exit\n"
         << "  --threads <n>               Number of worker threads (0=auto, default: hardware concurrency)\n"
+        << "  --pin-threads               Bind each worker thread to one CPU, filling NUMA nodes in turn\n"
         << "  --csv <path>                Write ratings table as CSV\n"
         << "  --json <path>               Write ratings table as JSON\n"
         << "  --markdown                  Print tables as Markdown\n"
         << "  --fastchess                 Use fastchess-style 1v1 stats (default when exactly 2 players)\n"
         << "  --bayeselo                  Use BayesElo-style multi-player ratings/LOS matrices\n"
         << "  --planned-games <n>         Print N as the planned game count (e.g. 457/1000)\n"
-        << "  --pgn-dir <path>            Recursively add all .pgn files under directory\n"
+        << "  --pgn-dir <path>            Recursively add all .pgn and .pgn.gz files under directory\n"
         << "  --max-games <n>             Stop after N accepted games\n"
         << "  --max-size <bytes|k|m|g>    Soft cap on internal memory estimate (k=KiB, m=MiB, g=GiB)\n"
-        << "  --keep-moves                Retain SAN move text (otherwise dropped after ply counting)\n"
+        << "  --keep-moves                Retain SAN move text (otherwise movetext is only scanned to count plies)\n"
+        << "  --io <mmap|stream>          Input backend: map files once (default) or read chunks via ifstream\n"
+        << "  --cache-dir <path>          Cache parsed games per input file here; unchanged files skip parsing on later runs\n"
+        << "  --pgn-index                 Split large files by game using <file>.pgnidx sidecars (built on first use)\n"
+        << "  --state <path>              Remember per-file progress and results here; re-runs only parse appended games\n"
+        << "  --follow                    Keep running: parse games appended to the inputs and print updated ratings\n"
+        << "  --chunk-size <bytes|k|m|g>  Bytes per parse task (default: input size / (4 x threads), 256k..64m)\n"
         << "\nFilters:\n"
-        << "  --min-plies <n>             Minimum plies (half-moves)\n"
+        << "  --min-plies <n>             Minimum plies (half-moves; move numbers, comments, variations and the result are not counted)\n"
         << "  --max-plies <n>             Maximum plies (half-moves)\n"
         << "  --min-moves <n>             Minimum moves (converted to plies)\n"
         << "  --max-moves <n>             Maximum moves (converted to plies)\n"
         << "  --min-time <dur>            Minimum duration; accepts seconds or suffix h/m/s (e.g. 300, 5m, 1h)\n"
-        << "  --max-time <dur>            Maximum duration; e.g. \"300+2\" uses only the base time (300); increments are ignored\n"
+        << "  --max-time <dur>            Maximum duration. A game's duration is estimated per side from its TimeControl:\n"
+        << "                              base time plus increment per move (\"300+2\" over 40 moves = 380); \"?\" and \"-\" never match\n"
         << "  --white-name <substr>       Require White name contains substring\n"
         << "  --black-name <substr>       Require Black name contains substring\n"
         << "  --either-name <substr>      Require either name contains substring\n"
         << "  --exclude-name <substr>     Exclude games if either name contains substring\n"
+        << "  --include-names-file <path> Require either name contains one of the substrings listed in the file (one per line)\n"
+        << "  --exclude-names-file <path> Exclude games if either name contains one of the substrings listed in the file\n"
         << "  --result <1-0|0-1|draw|1/2-1/2> Filter by result\n"
         << "  --termination <value>       Filter by Termination tag (case-insensitive)\n"
         << "  --require-complete          Skip games missing required metadata/result\n"
@@ -122,7 +211,7 @@ void print_help() {
         << "\nNotes:\n"
         << "  - Provide one or more PGN files to rate. Games are filtered before rating.\n"
         << "  - Size suffixes: k=KiB, m=MiB, g=GiB. Duration suffixes: s, m, h.\n"
-        << "  - When --keep-moves is omitted, moves are discarded after ply counting and only compact pairings/results are retained, reducing memory.\n"
+        << "  - When --keep-moves is omitted, movetext is only scanned to count plies and only compact pairings/results are retained, reducing memory.\n"
         << "  - Use --keep-moves if you plan to export move text or perform move-level analysis later.\n";
 }
 
@@ -277,6 +366,18 @@ CliOptions parse_cli(int argc, char** argv) {
             options.filters.exclude_name = argv[++i];
             continue;
         }
+        if (arg == "--include-names-file" || arg == "--exclude-names-file") {
+            if (!require_value(arg, i)) {
+                std::exit(1);
+            }
+            auto& list = arg == "--include-names-file" ? options.filters.include_names : options.filters.exclude_names;
+            const std::filesystem::path file = argv[++i];
+            if (!read_name_patterns(file, list)) {
+                std::cerr << "Failed to read " << arg << " " << file << "\n";
+                std::exit(1);
+            }
+            continue;
+        }
         if (arg == "--result") {
             if (!require_value(arg, i)) {
                 std::exit(1);
@@ -344,7 +445,10 @@ CliOptions parse_cli(int argc, char** argv) {
             if (!require_value(arg, i)) {
                 std::exit(1);
             }
-            append_pgn_files_from_dir(argv[++i], options.files);
+            std::filesystem::path dir = argv[++i];
+            if (check_pgn_dir(dir)) {
+                options.dirs.push_back(std::move(dir));
+            }
             continue;
         }
         if (arg == "--max-games") {
@@ -359,6 +463,58 @@ CliOptions parse_cli(int argc, char** argv) {
             options.keep_moves = true;
             continue;
         }
+        if (arg == "--io") {
+            if (!require_value(arg, i)) {
+                std::exit(1);
+            }
+            std::string backend = argv[++i];
+            if (backend == "mmap") {
+                options.io_backend = IoBackend::Mmap;
+            } else if (backend == "stream") {
+                options.io_backend = IoBackend::Stream;
+            } else {
+                std::cerr << "Invalid value for --io: " << backend << " (expected mmap or stream)\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg == "--cache-dir") {
+            if (!require_value(arg, i)) {
+                std::exit(1);
+            }
+            options.cache_dir = argv[++i];
+            continue;
+        }
+        if (arg == "--state") {
+            if (!require_value(arg, i)) {
+                std::exit(1);
+            }
+            options.state_file = argv[++i];
+            continue;
+        }
+        if (arg == "--follow") {
+            options.follow = true;
+            continue;
+        }
+        if (arg == "--pin-threads") {
+            options.pin_threads = true;
+            continue;
+        }
+        if (arg == "--pgn-index") {
+            options.pgn_index = true;
+            continue;
+        }
+        if (arg == "--chunk-size") {
+            if (!require_value(arg, i)) {
+                std::exit(1);
+            }
+            options.chunk_bytes = parse_size(argv[++i]);
+            if (!options.chunk_bytes || *options.chunk_bytes == 0) {
+                std::cerr << "Invalid value for --chunk-size: " << argv[i] << "\n";
+                std::exit(1);
+            }
+            continue;
+        }
         if (arg == "--max-size") {
             if (!require_value(arg, i)) {
                 std::exit(1);
@@ -370,11 +526,15 @@ CliOptions parse_cli(int argc, char** argv) {
             }
             continue;
         }
+        if (arg == "-") {
+            options.files.emplace_back(arg);
+            continue;
+        }
         if (!arg.empty() && arg.front() != '-') {
             std::filesystem::path candidate = arg;
             std::error_code ec;
             if (std::filesystem::is_directory(candidate, ec)) {
-                append_pgn_files_from_dir(candidate, options.files);
+                options.dirs.push_back(candidate);
             } else {
                 options.files.push_back(candidate);
             }
@@ -386,30 +546,107 @@ CliOptions parse_cli(int argc, char** argv) {
 
 int main(int argc, char** argv) {
     auto options = parse_cli(argc, argv);
-    if (options.files.empty()) {
+    if (options.files.empty() && options.dirs.empty()) {
         print_help();
         return 1;
     }
 
-    // 1 MiB chunks: large enough to amortize file I/O overhead, small enough to keep parallelism granular.
-    constexpr std::size_t default_chunk_bytes = 1u << 20;
-    std::vector<ChunkRange> chunks;
-    chunks.reserve(options.files.size());
-    for (const auto& file : options.files) {
-        auto ranges = split_pgn_file(file, default_chunk_bytes);
-        chunks.insert(chunks.end(), ranges.begin(), ranges.end());
+    constexpr std::size_t kStreamBlocksPerThread = 2;
+    constexpr std::size_t kStreamReaderThreads = 2;
+
+    if (options.cache_dir) {
+        std::error_code ec;
+        if (options.keep_moves) {
+            std::cerr << "--cache-dir is ignored with --keep-moves (moves are not cached)\n";
+            options.cache_dir.reset();
+        } else if (std::filesystem::create_directories(*options.cache_dir, ec); ec) {
+            std::cerr << "Cannot use cache directory " << *options.cache_dir << ": " << ec.message() << "\n";
+            options.cache_dir.reset();
+        }
+    }
+
+    // --state holds the player table and, per file, the parsed offset and accepted results of
+    // earlier runs. Results are only reusable under the same filters and without limits that
+    // depend on the whole input.
+    IngestState previous_state;
+    if (options.state_file) {
+        if (options.keep_moves || options.max_games || options.max_bytes) {
+            std::cerr << "--state is ignored with --keep-moves, --max-games or --max-size\n";
+            options.state_file.reset();
+        } else if (auto loaded = load_ingest_state(*options.state_file)) {
+            if (loaded->filter_fingerprint == filter_fingerprint(options.filters)) {
+                previous_state = std::move(*loaded);
+            } else {
+                std::cerr << "Filters differ from the run that wrote " << *options.state_file << "; re-reading all input\n";
+            }
+        } else if (std::error_code ec; std::filesystem::exists(*options.state_file, ec)) {
+            std::cerr << "Ignoring unreadable state file " << *options.state_file << "\n";
+        }
     }
 
-    ThreadPool pool(options.threads);
-    std::mutex games_mutex;
+    if (options.follow && (options.max_games || options.max_bytes)) {
+        std::cerr << "--follow cannot be combined with --max-games or --max-size\n";
+        return 1;
+    }
+    // --state and --follow parse regular files by offset and keep each file's results with it.
+    const bool track_offsets = options.state_file.has_value() || options.follow;
+    // Finding the last complete game and checking the head of a file are done on its mapping.
+    if (track_offsets && options.io_backend == IoBackend::Stream) {
+        std::cerr << (options.follow ? "--follow" : "--state") << " reads files through mmap and cannot be combined with --io stream\n";
+        return 1;
+    }
+
+    // Sizes of the listed files pick the chunk size; stream inputs and files found by walking
+    // directories are not known up front and not counted.
+    std::vector<InputFile> stream_inputs;
+    std::vector<InputFile> inputs;
+    std::size_t total_bytes = 0;
+    for (std::size_t order = 0; order < options.files.size(); ++order) {
+        const auto& file = options.files[order];
+        if (is_stream_input(file)) {
+            stream_inputs.push_back(InputFile{file, 0, order});
+            continue;
+        }
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(file, ec);
+        if (ec) {
+            std::cerr << "Failed to open " << file << ": " << ec.message() << "\n";
+            continue;
+        }
+        inputs.push_back(InputFile{file, static_cast<std::size_t>(size), order});
+        total_bytes += static_cast<std::size_t>(size);
+    }
+    const std::size_t workers = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t chunk_bytes = options.chunk_bytes.value_or(choose_chunk_bytes(total_bytes, workers));
+    // A file larger than all listed input together (e.g. one found in a directory) is sized on its own.
+    auto file_chunk_bytes = [&](std::size_t file_size) {
+        return options.chunk_bytes.value_or(choose_chunk_bytes(std::max(total_bytes, file_size), workers));
+    };
+
+    ThreadPool pool(options.threads, options.pin_threads);
     std::vector<Game> games;
     std::atomic_size_t accepted{0};
     std::atomic_bool max_reached{false};
     std::vector<Pairing> pairings;
     std::vector<std::string> player_names;
-    std::unordered_map<std::string, std::size_t> name_index;
+    std::unordered_map<std::string, std::size_t, NameHash, std::equal_to<>> name_index;
+    for (auto& name : previous_state.players) {
+        name_index.emplace(name, player_names.size());
+        player_names.push_back(std::move(name));
+    }
+    std::unordered_map<std::string, IngestedFile*> previous_files;
+    for (auto& entry : previous_state.files) {
+        previous_files.emplace(entry.path, &entry);
+    }
+    std::deque<IngestedFile> tracked_files; // stable addresses for ChunkTask::tracked
+    std::vector<std::size_t> tracked_orders; // InputFile::order of each tracked file
     std::atomic_size_t estimated_bytes{0};
     const bool use_pairings = !options.keep_moves;
+    // Games the filters reject from their tags are dropped before their movetext is scanned, except
+    // while a file is being cached: the cache must hold every game.
+    const FilterProgram filter_program(options.filters);
+    const ParseOptions parse_options{options.keep_moves, &filter_program};
+    const ParseOptions unfiltered_parse_options{options.keep_moves};
     constexpr std::size_t kPairingBytes = sizeof(Pairing); // Heuristic; we intentionally avoid extra margins to keep limits intuitive (see PR discussion).
     constexpr std::size_t kNameOverhead = sizeof(std::string); // Same here: this tracks control blocks only so --max-size is a soft cap by design.
     auto try_add_bounded = [&](std::atomic_size_t& counter, std::size_t max_value, std::size_t delta) -> bool {
@@ -442,209 +679,742 @@ int main(int argc, char** argv) {
         return true;
     };
 
-    for (const auto& chunk : chunks) {
-        pool.enqueue([&, chunk]() {
-            auto parsed = parse_pgn_chunk(chunk.file, chunk.start_offset, chunk.end_offset);
-            std::vector<Game> local_games;
-            std::vector<Pairing> local_pairs;
-            if (!parsed) {
-                std::cerr << "Failed to parse chunk: " << chunk.file
-                          << " (offsets " << chunk.start_offset << "-" << chunk.end_offset << ")\n";
-                return;
+    // Workers never touch the global player table: each chunk numbers its own players, and the
+    // results are merged into global ids once the pool is idle, in command-line order of the inputs
+    // and then by position within each file. Player ids and pairing order are then the same from run
+    // to run whatever the thread count.
+    struct ChunkResult {
+        std::size_t input_order{0};
+        std::string source;
+        std::uint64_t position{0}; // offset or sequence number within source
+        IngestedFile* tracked{nullptr};
+        std::vector<std::string> names; // local player id -> name
+        std::vector<Pairing> pairs;     // indices into names
+        std::vector<Game> games;
+    };
+    // Results are collected per NUMA node of the finishing worker (one list unless --pin-threads
+    // spans nodes), so workers on different sockets never share a lock or a vector.
+    struct alignas(64) NodeResults {
+        std::mutex mutex;
+        std::vector<ChunkResult> results;
+    };
+    std::deque<NodeResults> node_results(pool.node_count());
+    std::vector<ChunkResult> chunk_results;
+
+    auto consume_chunk = [&](const ParsedChunk& parsed, std::size_t input_order, std::string source, std::uint64_t position,
+                             IngestedFile* tracked = nullptr) {
+        ChunkResult result{input_order, std::move(source), position, tracked, {}, {}, {}};
+        result.games.reserve(use_pairings ? 0 : parsed.games.size());
+        result.pairs.reserve(use_pairings ? parsed.games.size() : 0);
+
+        auto try_accept_game = [&]() -> bool {
+            if (!options.max_games) {
+                accepted.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (!try_add_bounded(accepted, *options.max_games, 1)) {
+                return false;
+            }
+            return true;
+        };
+
+        // Local ids by the chunk's player dictionary id; views without one fall back to a map.
+        constexpr std::size_t kUnassigned = std::numeric_limits<std::size_t>::max();
+        std::vector<std::size_t> local_of(use_pairings ? parsed.players.size() : 0, kUnassigned);
+        std::unordered_map<std::string_view, std::size_t> unindexed;
+        auto local_slot = [&](std::uint32_t id, std::string_view name) -> std::size_t& {
+            if (id != kNoTagId && id < local_of.size()) {
+                return local_of[id];
+            }
+            return unindexed.try_emplace(name, kUnassigned).first->second;
+        };
+
+        ChunkFilter filter(parsed, filter_program);
+        for (std::size_t game_index = 0; game_index < parsed.games.size(); ++game_index) {
+            const auto& g = parsed.games[game_index];
+            if (!filter.passes(game_index)) {
+                continue;
             }
-            local_games.reserve(parsed->size());
-            local_pairs.reserve(parsed->size());
 
-            auto try_accept_game = [&]() -> bool {
-                if (!options.max_games) {
-                    accepted.fetch_add(1, std::memory_order_relaxed);
-                    return true;
+            if (use_pairings) {
+                if (g.outcome == GameResult::Outcome::Unknown) {
+                    continue;
+                }
+
+                auto& w_idx = local_slot(g.white_id, g.white);
+                auto& b_idx = local_slot(g.black_id, g.black);
+                // Names are charged once per chunk here and refunded on merge when already known.
+                std::size_t name_bytes_needed = 0;
+                if (w_idx == kUnassigned) {
+                    name_bytes_needed += g.white.size() + kNameOverhead;
                 }
-                if (!try_add_bounded(accepted, *options.max_games, 1)) {
-                    return false;
+                if (b_idx == kUnassigned && &b_idx != &w_idx) {
+                    name_bytes_needed += g.black.size() + kNameOverhead;
+                }
+                if (name_bytes_needed > 0) {
+                    if (!reserve_bytes(name_bytes_needed)) {
+                        break;
+                    }
                 }
-                return true;
-            };
 
-            for (auto& g : *parsed) {
-                if (!options.keep_moves) {
-                    g.moves.clear();
-                    g.moves.shrink_to_fit();
+                double score = 0.5;
+                if (g.outcome == GameResult::Outcome::WhiteWin) {
+                    score = 1.0;
+                } else if (g.outcome == GameResult::Outcome::BlackWin) {
+                    score = 0.0;
                 }
-                if (!passes_filters(g, options.filters)) {
-                    continue;
+                if (!reserve_bytes(kPairingBytes)) {
+                    break;
+                }
+                if (!try_accept_game()) {
+                    max_reached.store(true, std::memory_order_relaxed);
+                    break;
                 }
 
-                if (use_pairings) {
-                    if (g.result.outcome == GameResult::Outcome::Unknown) {
-                        continue;
-                    }
+                if (w_idx == kUnassigned) {
+                    w_idx = result.names.size();
+                    result.names.emplace_back(g.white);
+                }
+                if (b_idx == kUnassigned) {
+                    b_idx = result.names.size();
+                    result.names.emplace_back(g.black);
+                }
+                result.pairs.push_back(Pairing{w_idx, b_idx, score});
+            } else {
+                if (!try_accept_game()) {
+                    max_reached.store(true, std::memory_order_relaxed);
+                    break;
+                }
+                result.games.push_back(to_game(parsed, game_index));
+            }
+        }
 
-                    std::size_t w_idx = 0;
-                    std::size_t b_idx = 0;
-                    {
-                        std::scoped_lock lock(games_mutex);
-                        if (options.max_games && accepted.load(std::memory_order_acquire) >= *options.max_games) {
-                            max_reached.store(true, std::memory_order_relaxed);
-                            break;
-                        }
-                        std::size_t name_bytes_needed = 0;
-                        bool white_missing = false;
-                        bool black_missing = false;
-
-                        auto itw = name_index.find(g.meta.white);
-                        if (itw == name_index.end()) {
-                            white_missing = true;
-                            name_bytes_needed += g.meta.white.size() + kNameOverhead;
-                        } else {
-                            w_idx = itw->second;
-                        }
-                        auto itb = name_index.find(g.meta.black);
-                        if (itb == name_index.end()) {
-                            black_missing = true;
-                            name_bytes_needed += g.meta.black.size() + kNameOverhead;
-                        } else {
-                            b_idx = itb->second;
-                        }
+        if (!result.games.empty() || !result.pairs.empty()) {
+            auto& node = node_results[pool.current_node()];
+            std::scoped_lock lock(node.mutex);
+            node.results.push_back(std::move(result));
+        }
+    };
+    // Call only while the pool is idle.
+    auto merge_chunk_results = [&]() {
+        for (auto& node : node_results) {
+            chunk_results.insert(chunk_results.end(),
+                                 std::make_move_iterator(node.results.begin()),
+                                 std::make_move_iterator(node.results.end()));
+            node.results.clear();
+        }
+        std::stable_sort(chunk_results.begin(), chunk_results.end(), [](const ChunkResult& a, const ChunkResult& b) {
+            return std::tie(a.input_order, a.source, a.position) < std::tie(b.input_order, b.source, b.position);
+        });
+        // Grow the targets once, and free each result as soon as it is merged.
+        std::unordered_map<std::vector<Pairing>*, std::size_t> incoming;
+        std::size_t incoming_games = 0;
+        for (const auto& result : chunk_results) {
+            incoming[result.tracked ? &result.tracked->pairings : &pairings] += result.pairs.size();
+            incoming_games += result.games.size();
+        }
+        for (auto [target, count] : incoming) {
+            target->reserve(target->size() + count);
+        }
+        games.reserve(games.size() + incoming_games);
+        std::vector<std::size_t> global;
+        for (auto& result : chunk_results) {
+            global.clear();
+            for (auto& name : result.names) {
+                auto [it, inserted] = name_index.try_emplace(name, player_names.size());
+                if (inserted) {
+                    player_names.push_back(std::move(name));
+                } else if (options.max_bytes) {
+                    estimated_bytes.fetch_sub(name.size() + kNameOverhead, std::memory_order_relaxed);
+                }
+                global.push_back(it->second);
+            }
+            auto& target = result.tracked ? result.tracked->pairings : pairings;
+            for (const auto& pair : result.pairs) {
+                target.push_back(Pairing{global[pair.white], global[pair.black], pair.score});
+            }
+            games.insert(games.end(),
+                         std::make_move_iterator(result.games.begin()),
+                         std::make_move_iterator(result.games.end()));
+            result = ChunkResult{};
+        }
+        chunk_results.clear();
+    };
 
-                        if (name_bytes_needed > 0) {
-                            if (!reserve_bytes(name_bytes_needed)) {
-                                break;
-                            }
-                        }
-                        if (white_missing) {
-                            w_idx = player_names.size();
-                            name_index[g.meta.white] = w_idx;
-                            player_names.push_back(g.meta.white);
-                        }
-                        if (black_missing) {
-                            b_idx = player_names.size();
-                            name_index[g.meta.black] = b_idx;
-                            player_names.push_back(g.meta.black);
-                        }
-                    }
+    auto parse_chunk = [&](const ChunkTask& task) {
+        const auto& chunk = task.range;
+        const auto& chunk_options = task.cache ? unfiltered_parse_options : parse_options;
+        auto parsed = task.mapping ? parse_pgn_chunk_views(task.mapping, chunk.start_offset, chunk.end_offset, chunk_options)
+                                   : parse_pgn_chunk_views(chunk.file, chunk.start_offset, chunk.end_offset, chunk_options);
+        if (!parsed) {
+            std::cerr << "Failed to parse chunk: " << chunk.file
+                      << " (offsets " << chunk.start_offset << "-" << chunk.end_offset << ")\n";
+            if (task.cache && !task.cache->abandon(task.range_index)) {
+                std::cerr << "Failed to write cache " << task.cache->cache_file() << "\n";
+            }
+            if (task.index && !task.index->abandon(task.range_index)) {
+                std::cerr << "Failed to write index " << task.index->index_file() << "\n";
+            }
+            return;
+        }
+        if (task.cache && !task.cache->add(task.range_index, *parsed)) {
+            std::cerr << "Failed to write cache " << task.cache->cache_file() << "\n";
+        }
+        if (task.index &&
+            !task.index->add(task.range_index, find_game_starts(task.mapping->view(), chunk.start_offset, chunk.end_offset))) {
+            std::cerr << "Failed to write index " << task.index->index_file() << "\n";
+        }
+        consume_chunk(*parsed, task.input_order, chunk.file.string(), chunk.start_offset, task.tracked);
+    };
+    // A file's chunks are queued as one splittable range: the worker that takes it hands off halves
+    // that idle workers steal, so the tail of a large file spreads over the pool instead of waiting
+    // behind one worker.
+    auto enqueue_chunks = [&](std::vector<ChunkTask> tasks) {
+        auto shared = std::make_shared<const std::vector<ChunkTask>>(std::move(tasks));
+        pool.enqueue_range(0, shared->size(), 1, [&parse_chunk, shared](std::size_t i) { parse_chunk((*shared)[i]); });
+    };
 
-                    double score = 0.5;
-                    if (g.result.outcome == GameResult::Outcome::WhiteWin) {
-                        score = 1.0;
-                    } else if (g.result.outcome == GameResult::Outcome::BlackWin) {
-                        score = 0.0;
-                    }
-                    if (!reserve_bytes(kPairingBytes)) {
-                        break;
+    // Files no larger than a chunk are parsed whole, several to a task: the worker reads each one
+    // with a single read and inflates it first when it turns out to be gzip.
+    auto parse_whole_file = [&](const InputFile& input, const std::optional<GameCacheKey>& cache_key) {
+        std::vector<char> text;
+        if (!read_whole_file(input, text)) {
+            std::cerr << "Failed to open " << input.path << "\n";
+            return;
+        }
+        if (is_gzip_data(std::string_view(text.data(), text.size()))) {
+            std::vector<char> inflated;
+            if (!gzip_supported()) {
+                std::cerr << "Skipping " << input.path << ": gzip input requires a build with zlib\n";
+                return;
+            }
+            if (!inflate_gzip(std::string_view(text.data(), text.size()), inflated)) {
+                std::cerr << "Failed to decompress " << input.path << "\n";
+                return;
+            }
+            text = std::move(inflated);
+        }
+        auto parsed = parse_pgn_buffer(std::move(text), cache_key ? unfiltered_parse_options : parse_options);
+        if (cache_key) {
+            GameCacheWriter writer(game_cache_path(*options.cache_dir, *cache_key), *cache_key, 1);
+            if (!writer.add(0, parsed)) {
+                std::cerr << "Failed to write cache " << writer.cache_file() << "\n";
+            }
+        }
+        consume_chunk(parsed, input.order, input.path.string(), 0);
+    };
+    // Cached games go straight to filtering; only a cache whose header matches is tried.
+    auto consume_cached = [&](const InputFile& input, const std::filesystem::path& cache_file, const GameCacheKey& key) {
+        auto cached = load_game_cache(cache_file, key);
+        if (!cached) {
+            return false;
+        }
+        consume_chunk(*cached, input.order, input.path.string(), 0);
+        return true;
+    };
+    auto cache_key_for = [&](const std::filesystem::path& file) -> std::optional<GameCacheKey> {
+        return options.cache_dir ? game_cache_key(file) : std::nullopt;
+    };
+    auto parse_small_file = [&](const InputFile& input) {
+        const auto cache_key = cache_key_for(input.path);
+        if (cache_key && consume_cached(input, game_cache_path(*options.cache_dir, *cache_key), *cache_key)) {
+            return;
+        }
+        parse_whole_file(input, cache_key);
+    };
+    // Guards batch and compressed_inputs, which directory-walk tasks feed concurrently.
+    std::mutex dispatch_mutex;
+    std::vector<InputFile> batch;
+    std::size_t batch_bytes = 0;
+    auto flush_batch = [&]() {
+        if (batch.empty()) {
+            return;
+        }
+        pool.enqueue([&, files = std::move(batch)]() {
+            for (const auto& input : files) {
+                parse_small_file(input);
+            }
+        });
+        batch = {};
+        batch_bytes = 0;
+    };
+
+    // Splitting is just a size lookup (workers find game boundaries themselves), so chunks are
+    // enqueued file by file and parsing starts while later files are still being opened.
+    std::vector<ChunkTask> compressed_inputs;
+    // --state: a regular PGN file is parsed from where the last run stopped up to the end of its last
+    // complete game; a trailing game that is still being written is left for the next run. If the
+    // start of the file changed, it was replaced and is read again from offset 0.
+    auto enqueue_tail = [&](IngestedFile& tracked, std::size_t input_order, std::shared_ptr<const MappedFile> mapping, std::size_t start) {
+        const auto data = mapping->view();
+        const std::size_t end = start + complete_games_end(data.substr(start));
+        tracked.offset = end;
+        tracked.head_hash = file_head_hash(data, end);
+        std::vector<ChunkTask> tasks;
+        for (auto& range : split_pgn_span(mapping->path(), start, end, file_chunk_bytes(end - start))) {
+            tasks.push_back(ChunkTask{std::move(range), mapping, nullptr, nullptr, 0, &tracked, input_order});
+        }
+        enqueue_chunks(std::move(tasks));
+    };
+    auto add_tracked = [&](const InputFile& input) -> bool {
+        auto mapping = MappedFile::open(input.path);
+        if (!mapping || is_gzip_data(mapping->view())) {
+            return false;
+        }
+        std::error_code ec;
+        auto path = std::filesystem::absolute(input.path, ec).lexically_normal().string();
+        const auto data = mapping->view();
+        IngestedFile* tracked = nullptr;
+        std::size_t start = 0;
+        {
+            std::scoped_lock lock(dispatch_mutex);
+            tracked = &tracked_files.emplace_back();
+            tracked_orders.push_back(input.order);
+            auto it = previous_files.find(path);
+            if (it != previous_files.end()) {
+                auto& before = *it->second;
+                if (before.offset <= data.size() && file_head_hash(data, before.offset) == before.head_hash) {
+                    start = before.offset;
+                    tracked->pairings = std::move(before.pairings);
+                }
+                previous_files.erase(it);
+            }
+        }
+        tracked->path = std::move(path);
+        enqueue_tail(*tracked, input.order, std::move(mapping), start);
+        return true;
+    };
+    // Splits a plain PGN file into chunk tasks, writing its cache (when given a key) and .pgnidx
+    // sidecar from the parsed chunks. mapping is null with --io stream.
+    auto enqueue_file_chunks = [&](const InputFile& input, std::shared_ptr<const MappedFile> mapping,
+                                   const std::optional<GameCacheKey>& cache_key) {
+        const auto& file = input.path;
+        // With an up-to-date .pgnidx the chunks hold equal numbers of games and start exactly on game
+        // boundaries; otherwise they are raw byte ranges and the sidecar is built from them.
+        const std::size_t file_bytes = mapping ? mapping->size() : input.size;
+        const std::size_t range_bytes = file_chunk_bytes(input.size);
+        std::optional<GameIndex> index;
+        std::shared_ptr<GameIndexWriter> index_writer;
+        const auto index_key = options.pgn_index ? (cache_key ? cache_key : game_cache_key(file)) : std::nullopt;
+        if (index_key) {
+            index = load_game_index(game_index_path(file), *index_key);
+        }
+        auto ranges = index ? split_pgn_index(file, *index, (file_bytes + range_bytes - 1) / range_bytes)
+                            : split_pgn_range(file, file_bytes, range_bytes);
+        if (index_key && !index && mapping) {
+            index_writer = std::make_shared<GameIndexWriter>(game_index_path(file), *index_key, ranges.size());
+        }
+        std::shared_ptr<GameCacheWriter> cache;
+        if (cache_key) {
+            cache = std::make_shared<GameCacheWriter>(game_cache_path(*options.cache_dir, *cache_key), *cache_key, ranges.size());
+        }
+        std::vector<ChunkTask> tasks;
+        tasks.reserve(ranges.size());
+        for (std::size_t i = 0; i < ranges.size(); ++i) {
+            tasks.push_back(ChunkTask{std::move(ranges[i]), mapping, cache, index_writer, i, nullptr, input.order});
+        }
+        enqueue_chunks(std::move(tasks));
+    };
+    auto add_input = [&](const InputFile& input) {
+        const auto& file = input.path;
+        if (track_offsets && add_tracked(input)) {
+            return;
+        }
+        if (input.size <= chunk_bytes) {
+            std::scoped_lock lock(dispatch_mutex);
+            batch.push_back(input);
+            batch_bytes += input.size;
+            if (batch_bytes >= chunk_bytes) {
+                flush_batch();
+            }
+            return;
+        }
+        const auto cache_key = cache_key_for(file);
+        if (cache_key) {
+            auto cache_file = game_cache_path(*options.cache_dir, *cache_key);
+            if (game_cache_matches(cache_file, *cache_key)) {
+                pool.enqueue([&, input, cache_key, cache_file = std::move(cache_file)]() {
+                    if (consume_cached(input, cache_file, *cache_key)) {
+                        return;
                     }
-                    if (!try_accept_game()) {
-                        max_reached.store(true, std::memory_order_relaxed);
-                        break;
+                    // Re-parse in chunks like an uncached file, which rewrites the cache.
+                    std::cerr << "Ignoring damaged cache " << cache_file << "\n";
+                    auto mapping = options.io_backend == IoBackend::Mmap ? MappedFile::open(input.path) : nullptr;
+                    if (mapping ? is_gzip_data(mapping->view()) : is_gzip_file(input.path)) {
+                        parse_whole_file(input, cache_key); // no chunked path for gzip once the inputs are dispatched
+                        return;
                     }
+                    enqueue_file_chunks(input, std::move(mapping), cache_key);
+                });
+                return;
+            }
+        }
+        // Map each file once; every chunk task shares the mapping and it is unmapped with the last one.
+        std::shared_ptr<const MappedFile> mapping;
+        if (options.io_backend == IoBackend::Mmap) {
+            mapping = MappedFile::open(file);
+        }
+        if (mapping ? is_gzip_data(mapping->view()) : is_gzip_file(file)) {
+            std::scoped_lock lock(dispatch_mutex);
+            compressed_inputs.push_back(
+                ChunkTask{ChunkRange{file, 0, mapping ? mapping->size() : input.size}, mapping, nullptr, nullptr, 0, nullptr, input.order});
+            return;
+        }
+        enqueue_file_chunks(input, std::move(mapping), cache_key);
+    };
 
-                    local_pairs.push_back(Pairing{w_idx, b_idx, score});
-                } else {
-                    if (!try_accept_game()) {
-                        max_reached.store(true, std::memory_order_relaxed);
-                        break;
-                    }
-                    local_games.push_back(std::move(g));
-                }
+    // Directories are listed by pool tasks, one per directory, and every PGN file found is
+    // dispatched straight away, so parsing overlaps with the rest of the walk.
+    DirectoryWalker walker(pool, [](const std::filesystem::path& dir, const std::error_code& ec) {
+        std::cerr << "Error while scanning " << dir << ": " << ec.message() << "\n";
+    });
+    std::vector<std::atomic_size_t> found_per_dir(options.dirs.size());
+    for (std::size_t i = 0; i < options.dirs.size(); ++i) {
+        walker.walk(options.dirs[i], [&, &found = found_per_dir[i]](const std::filesystem::directory_entry& entry) {
+            if (!has_pgn_extension(entry.path())) {
+                return;
             }
+            std::error_code ec;
+            const auto size = entry.file_size(ec);
+            if (ec) {
+                std::cerr << "Failed to open " << entry.path() << ": " << ec.message() << "\n";
+                return;
+            }
+            found.fetch_add(1, std::memory_order_relaxed);
+            add_input(InputFile{entry.path(), static_cast<std::size_t>(size), options.files.size() + i});
+        });
+    }
+    for (const auto& input : inputs) {
+        add_input(input);
+    }
+    walker.wait();
+    {
+        std::scoped_lock lock(dispatch_mutex);
+        flush_batch();
+    }
+    std::size_t found_total = 0;
+    for (std::size_t i = 0; i < options.dirs.size(); ++i) {
+        const auto found = found_per_dir[i].load(std::memory_order_relaxed);
+        if (found == 0) {
+            std::cerr << "No PGN files found under " << options.dirs[i] << "\n";
+        }
+        found_total += found;
+    }
+    if (inputs.empty() && stream_inputs.empty() && found_total == 0) {
+        print_help();
+        return 1;
+    }
 
-            if (!local_games.empty() || !local_pairs.empty()) {
-                std::scoped_lock lock(games_mutex);
-                if (!local_games.empty()) {
-                    games.insert(games.end(),
-                                 std::make_move_iterator(local_games.begin()),
-                                 std::make_move_iterator(local_games.end()));
-                }
-                if (!local_pairs.empty()) {
-                    pairings.insert(pairings.end(),
-                                    std::make_move_iterator(local_pairs.begin()),
-                                    std::make_move_iterator(local_pairs.end()));
-                }
+    // Non-seekable inputs and plain gzip files go through a staged pipeline: I/O threads read (and
+    // inflate) blocks of whole games into recycled buffers, workers parse them, and the results join
+    // the chunk results merged once the pool is idle. Readers block once every buffer is in flight,
+    // so memory is bounded by the pipeline depth, not by how far reading gets ahead of parsing.
+    struct StreamBlock {
+        std::size_t input_order{0};
+        std::string label;
+        std::uint64_t sequence{0};
+        std::vector<char> text;
+    };
+    BufferPool stream_buffers(kStreamBlocksPerThread * workers);
+    BoundedQueue<StreamBlock> read_blocks(stream_buffers.size());
+    auto stream_blocks = [&](std::istream& in, std::size_t input_order, const std::string& label) {
+        PgnStreamReader reader(in, chunk_bytes);
+        for (std::uint64_t sequence = 0;; ++sequence) {
+            auto buffer = stream_buffers.acquire();
+            if (!reader.next(buffer)) {
+                stream_buffers.release(std::move(buffer));
+                break;
             }
+            // At most one block per buffer is queued, so this never waits.
+            read_blocks.push(StreamBlock{input_order, label, sequence, std::move(buffer)});
+            pool.enqueue([&]() {
+                auto block = read_blocks.pop();
+                auto parsed = parse_pgn_buffer(std::move(block.text), parse_options);
+                consume_chunk(parsed, block.input_order, std::move(block.label), block.sequence);
+                stream_buffers.release(std::move(parsed.storage));
+            });
+        }
+        if (reader.failed()) {
+            std::cerr << "Read error on " << label << "\n";
+        }
+    };
+    std::vector<std::function<void()>> stream_readers;
+
+    // BGZF files are split into members and inflated in parallel on the pool; other gzip files are
+    // inflated as a stream by an I/O thread.
+    for (const auto& input : compressed_inputs) {
+        const auto& file = input.range.file;
+        if (!gzip_supported()) {
+            std::cerr << "Skipping " << file << ": gzip input requires a build with zlib\n";
+            continue;
+        }
+        auto members = input.mapping ? scan_bgzf_members(input.mapping->view()) : std::vector<GzipMember>{};
+        if (!members.empty()) {
+            enqueue_bgzf_file(
+                pool, input.mapping, std::move(members), file_chunk_bytes(input.range.end_offset), parse_options,
+                [&, source = file.string(), input_order = input.input_order](const ParsedChunk& parsed, std::size_t order) {
+                    consume_chunk(parsed, input_order, source, order);
+                },
+                [file](std::string_view error) { std::cerr << "Failed to decompress " << file << ": " << error << "\n"; });
+            continue;
+        }
+        stream_readers.push_back([&, file, input_order = input.input_order]() {
+            std::ifstream raw(file, std::ios::binary);
+            if (!raw) {
+                std::cerr << "Failed to open " << file << "\n";
+                return;
+            }
+            GzipStreambuf inflater(raw);
+            std::istream in(&inflater);
+            stream_blocks(in, input_order, file.string());
         });
     }
 
-    pool.wait_for_completion();
-    pool.shutdown();
-
-    BayesEloSolver solver;
-    RatingResult ratings;
-    if (use_pairings) {
-        ratings = solver.solve(pairings, player_names);
-    } else {
-        ratings = solver.solve(games);
+    for (const auto& input : stream_inputs) {
+        stream_readers.push_back([&, input]() {
+            if (input.path == "-") {
+                stream_blocks(std::cin, input.order, "<stdin>");
+                return;
+            }
+            std::ifstream file_in(input.path, std::ios::binary);
+            if (!file_in) {
+                std::cerr << "Failed to open " << input.path << "\n";
+                return;
+            }
+            stream_blocks(file_in, input.order, input.path.string());
+        });
     }
+    {
+        std::atomic_size_t next_reader{0};
+        std::vector<std::jthread> io_threads;
+        for (std::size_t i = 0; i < std::min(kStreamReaderThreads, stream_readers.size()); ++i) {
+            io_threads.emplace_back([&]() {
+                while (true) {
+                    const std::size_t k = next_reader.fetch_add(1);
+                    if (k >= stream_readers.size()) {
+                        break;
+                    }
+                    stream_readers[k]();
+                }
+            });
+        }
+    } // joins the readers; their last blocks may still be parsing
 
-    const auto selected_style = [&]() -> CliOptions::OutputStyle {
-        if (options.style != CliOptions::OutputStyle::Auto) {
-            return options.style;
+    // Results of files that were dropped or re-read from the start are gone; renumber players so
+    // only those with games remain.
+    auto compact_players = [&]() {
+        std::vector<std::size_t> remap(player_names.size(), std::numeric_limits<std::size_t>::max());
+        auto mark = [&](const std::vector<Pairing>& list) {
+            for (const auto& p : list) {
+                remap[p.white] = 0;
+                remap[p.black] = 0;
+            }
+        };
+        mark(pairings);
+        for (const auto& tracked : tracked_files) {
+            mark(tracked.pairings);
+        }
+        std::vector<std::string> kept;
+        for (std::size_t i = 0; i < player_names.size(); ++i) {
+            if (remap[i] == 0) {
+                remap[i] = kept.size();
+                kept.push_back(std::move(player_names[i]));
+            }
         }
-        const std::size_t player_count = use_pairings ? player_names.size() : ratings.players.size();
-        return player_count == 2 ? CliOptions::OutputStyle::Fastchess : CliOptions::OutputStyle::BayesElo;
-    }();
+        auto renumber = [&](std::vector<Pairing>& list) {
+            for (auto& p : list) {
+                p.white = remap[p.white];
+                p.black = remap[p.black];
+            }
+        };
+        renumber(pairings);
+        for (auto& tracked : tracked_files) {
+            renumber(tracked.pairings);
+        }
+        player_names = std::move(kept);
+        name_index.clear();
+        for (std::size_t i = 0; i < player_names.size(); ++i) {
+            name_index.emplace(player_names[i], i);
+        }
+    };
+    auto save_state = [&]() {
+        IngestState next_state{filter_fingerprint(options.filters), player_names, {tracked_files.begin(), tracked_files.end()}};
+        if (!save_ingest_state(*options.state_file, next_state)) {
+            std::cerr << "Failed to write state file " << *options.state_file << "\n";
+        }
+    };
+
+    auto report = [&]() -> int {
+        // Tracked files keep their pairings apart; only copy when there are any.
+        std::vector<Pairing> with_tracked;
+        if (!tracked_files.empty()) {
+            with_tracked = pairings;
+            for (const auto& tracked : tracked_files) {
+                with_tracked.insert(with_tracked.end(), tracked.pairings.begin(), tracked.pairings.end());
+            }
+        }
+        const auto& all_pairings = tracked_files.empty() ? pairings : with_tracked;
 
-    if (selected_style == CliOptions::OutputStyle::Fastchess) {
-        std::vector<Pairing> h2h_pairings;
-        std::vector<std::string> h2h_names;
+        BayesEloSolver solver;
+        RatingResult ratings;
         if (use_pairings) {
-            h2h_pairings = pairings;
-            h2h_names = player_names;
+            ratings = solver.solve(all_pairings, player_names);
         } else {
-            // Build a strict 1v1 pairing list from games so the results match fastchess output.
-            std::unordered_map<std::string, std::size_t> idx;
-            for (const auto& g : games) {
-                if (g.result.outcome == GameResult::Outcome::Unknown) {
-                    continue;
-                }
-                auto ensure = [&](const std::string& name) {
-                    auto it = idx.find(name);
-                    if (it != idx.end()) {
-                        return it->second;
+            ratings = solver.solve(games);
+        }
+
+        const auto selected_style = [&]() -> CliOptions::OutputStyle {
+            if (options.style != CliOptions::OutputStyle::Auto) {
+                return options.style;
+            }
+            const std::size_t player_count = use_pairings ? player_names.size() : ratings.players.size();
+            return player_count == 2 ? CliOptions::OutputStyle::Fastchess : CliOptions::OutputStyle::BayesElo;
+        }();
+
+        if (selected_style == CliOptions::OutputStyle::Fastchess) {
+            std::vector<Pairing> h2h_pairings;
+            std::vector<std::string> h2h_names;
+            if (use_pairings) {
+                h2h_pairings = all_pairings;
+                h2h_names = player_names;
+            } else {
+                // Build a strict 1v1 pairing list from games so the results match fastchess output.
+                std::unordered_map<std::string, std::size_t> idx;
+                for (const auto& g : games) {
+                    if (g.result.outcome == GameResult::Outcome::Unknown) {
+                        continue;
                     }
-                    std::size_t next = h2h_names.size();
-                    idx[name] = next;
-                    h2h_names.push_back(name);
-                    return next;
-                };
-                std::size_t w = ensure(g.meta.white);
-                std::size_t b = ensure(g.meta.black);
-                double score = 0.5;
-                if (g.result.outcome == GameResult::Outcome::WhiteWin) {
-                    score = 1.0;
-                } else if (g.result.outcome == GameResult::Outcome::BlackWin) {
-                    score = 0.0;
+                    auto ensure = [&](const std::string& name) {
+                        auto it = idx.find(name);
+                        if (it != idx.end()) {
+                            return it->second;
+                        }
+                        std::size_t next = h2h_names.size();
+                        idx[name] = next;
+                        h2h_names.push_back(name);
+                        return next;
+                    };
+                    std::size_t w = ensure(g.meta.white);
+                    std::size_t b = ensure(g.meta.black);
+                    double score = 0.5;
+                    if (g.result.outcome == GameResult::Outcome::WhiteWin) {
+                        score = 1.0;
+                    } else if (g.result.outcome == GameResult::Outcome::BlackWin) {
+                        score = 0.0;
+                    }
+                    h2h_pairings.push_back(Pairing{w, b, score});
                 }
-                h2h_pairings.push_back(Pairing{w, b, score});
             }
-        }
 
-        auto stats = compute_fastchess_head_to_head(h2h_pairings, h2h_names, 0, 1);
-        if (!stats) {
-            std::cerr << "fastchess-style output requires a strict 1v1 PGN (exactly 2 players, only games between them)\n";
-            return 1;
-        }
-        if (options.markdown) {
-            print_fastchess_head_to_head_markdown(*stats, options.planned_games);
+            auto stats = compute_fastchess_head_to_head(h2h_pairings, h2h_names, 0, 1);
+            if (!stats) {
+                std::cerr << "fastchess-style output requires a strict 1v1 PGN (exactly 2 players, only games between them)\n";
+                return 1;
+            }
+            if (options.markdown) {
+                print_fastchess_head_to_head_markdown(*stats, options.planned_games);
+            } else {
+                print_fastchess_head_to_head(*stats, options.planned_games);
+            }
         } else {
-            print_fastchess_head_to_head(*stats, options.planned_games);
+            if (options.markdown) {
+                print_ratings_markdown(ratings, options.planned_games);
+                print_los_matrix_markdown(ratings);
+            } else {
+                print_ratings(ratings, options.planned_games);
+                print_los_matrix(ratings);
+            }
         }
-    } else {
-        if (options.markdown) {
-            print_ratings_markdown(ratings, options.planned_games);
-            print_los_matrix_markdown(ratings);
-        } else {
-            print_ratings(ratings, options.planned_games);
-            print_los_matrix(ratings);
+        if (max_reached.load(std::memory_order_relaxed)) {
+            std::cerr << "Reached limit (--max-games or --max-size); remaining parsed games were discarded.\n";
         }
+        // Export failures are reported, not thrown: under --follow the next update tries again.
+        try {
+            if (options.csv) {
+                write_csv(ratings, *options.csv);
+            }
+            if (options.json) {
+                // Written aside and renamed so readers (e.g. a dashboard polling --follow output) never see a partial file.
+                auto temp = *options.json;
+                temp += ".tmp";
+                write_json(ratings, temp);
+                std::error_code ec;
+                std::filesystem::rename(temp, *options.json, ec);
+                if (ec) {
+                    std::cerr << "Failed to replace " << *options.json << ": " << ec.message() << "\n";
+                    return 1;
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    };
+
+    pool.wait_for_completion();
+    merge_chunk_results();
+    if (!tracked_files.empty()) {
+        compact_players();
+    }
+    if (options.state_file) {
+        save_state();
+    }
+    if (!options.follow) {
+        pool.shutdown();
+        return report();
+    }
+
+    // --follow: after the first report, wait for appends and parse only newly completed games
+    // before reporting again. Compressed and streamed inputs were read once and are not followed.
+    if (report() != 0) {
+        std::cerr << "--follow: this update was not fully written; retrying after the next change\n";
     }
-    if (max_reached.load(std::memory_order_relaxed)) {
-        std::cerr << "Reached limit (--max-games or --max-size); remaining parsed games were discarded.\n";
+    std::cout << std::flush;
+    FileWatcher watcher;
+    std::vector<std::size_t> followed; // indices into tracked_files
+    for (std::size_t k = 0; k < tracked_files.size(); ++k) {
+        if (watcher.add(tracked_files[k].path)) {
+            followed.push_back(k);
+        } else {
+            std::cerr << "Cannot watch " << tracked_files[k].path << "\n";
+        }
     }
-    if (options.csv) {
-        write_csv(ratings, *options.csv);
+    if (followed.empty()) {
+        std::cerr << "--follow: no regular PGN files to watch\n";
+        return 1;
     }
-    if (options.json) {
-        write_json(ratings, *options.json);
+    constexpr auto kFollowSettle = std::chrono::milliseconds(200);
+    while (true) {
+        const auto changed = watcher.wait(kFollowSettle);
+        bool restarted = false;
+        for (const std::size_t i : changed) {
+            auto& tracked = tracked_files[followed[i]];
+            auto mapping = MappedFile::open(tracked.path);
+            if (!mapping) {
+                continue;
+            }
+            std::size_t start = tracked.offset;
+            if (mapping->size() < start || file_head_hash(mapping->view(), start) != tracked.head_hash) {
+                std::cerr << tracked.path << " was truncated or replaced; reading it again\n";
+                tracked.pairings.clear();
+                start = 0;
+                restarted = true;
+            }
+            enqueue_tail(tracked, tracked_orders[followed[i]], std::move(mapping), start);
+        }
+        pool.wait_for_completion();
+        merge_chunk_results();
+        if (restarted) {
+            compact_players();
+        }
+        if (options.state_file) {
+            save_state();
+        }
+        std::cout << "\n";
+        if (report() != 0) {
+            std::cerr << "--follow: this update was not fully written; retrying after the next change\n";
+        }
+        std::cout << std::flush;
     }
-    return 0;
 }
@@ -1,67 +1,106 @@
 #include "chunk_splitter.h"
 
-#include <fstream>
+#include <algorithm>
+#include <cctype>
 #include <string>
+#include <system_error>
 #include <vector>
 
 namespace bayeselo {
 
-std::vector<ChunkRange> split_pgn_file(const std::filesystem::path& file, std::size_t chunk_bytes) {
-    std::vector<ChunkRange> ranges;
-    std::ifstream in(file, std::ios::binary);
-    if (!in) {
-        return ranges;
+namespace {
+
+constexpr std::string_view kEventPrefix = "[Event";
+
+bool is_event_line(std::string_view text, std::size_t pos) {
+    if (text.compare(pos, kEventPrefix.size(), kEventPrefix) != 0) {
+        return false;
+    }
+    const std::size_t after = pos + kEventPrefix.size();
+    if (after >= text.size()) {
+        return true;
     }
+    const char ch = text[after];
+    return ch == '"' || std::isspace(static_cast<unsigned char>(ch));
+}
 
-    in.seekg(0, std::ios::end);
-    const auto total = static_cast<std::size_t>(in.tellg());
-    in.seekg(0, std::ios::beg);
+} // namespace
 
-    std::size_t current_start = 0;
-    while (current_start < total) {
-        std::size_t tentative_end = std::min(current_start + chunk_bytes, total);
-        in.seekg(static_cast<std::streamoff>(tentative_end), std::ios::beg);
-        std::string line;
-        std::streampos line_start = in.tellg();
-        std::streampos pos = line_start;
-        constexpr std::string_view kEventPrefix = "[Event";
-        std::size_t last_pos = tentative_end;
-        bool found_event = false;
-        std::streampos prev_pos = pos;
-        // Move to next [Event] boundary
-        while (std::getline(in, line)) {
-            pos = in.tellg();
-            if (pos == prev_pos || in.eof() || in.fail()) {
-                break; // no forward progress; bail out to avoid infinite loop
-            }
-            prev_pos = pos;
-            if (!line.empty() && line.rfind(kEventPrefix, 0) == 0) {
-                char after = line.size() > kEventPrefix.size() ? line[kEventPrefix.size()] : '\0';
-                if (after != '\0' && after != '"' && !std::isspace(static_cast<unsigned char>(after))) {
-                    line_start = pos;
-                    continue;
-                }
-                auto event_pos = static_cast<std::size_t>(line_start);
-                if (event_pos > current_start) {
-                    tentative_end = event_pos;
-                }
-                found_event = true;
-                break;
-            }
-            last_pos = static_cast<std::size_t>(pos);
-            line_start = pos;
+std::size_t find_game_start(std::string_view text, std::size_t from) {
+    std::size_t pos = from;
+    while (pos < text.size()) {
+        if ((pos == 0 || text[pos - 1] == '\n') && is_event_line(text, pos)) {
+            return pos;
         }
-        if (!found_event && (in.eof() || in.fail())) {
-            tentative_end = total;
-        } else if (!found_event) {
-            tentative_end = last_pos;
+        pos = text.find("\n[", pos);
+        if (pos == std::string_view::npos) {
+            return std::string_view::npos;
         }
-        tentative_end = std::min(tentative_end, total);
-        ranges.push_back(ChunkRange{file, current_start, tentative_end});
-        current_start = tentative_end;
+        ++pos;
+    }
+    return std::string_view::npos;
+}
+
+std::size_t find_last_game_start(std::string_view text) {
+    std::size_t end = text.size();
+    while (end > 0) {
+        const std::size_t nl = text.rfind("\n[", end - 1);
+        if (nl == std::string_view::npos) {
+            break;
+        }
+        if (is_event_line(text, nl + 1)) {
+            return nl + 1;
+        }
+        if (nl == 0) {
+            break;
+        }
+        end = nl;
+    }
+    return is_event_line(text, 0) ? 0 : std::string_view::npos;
+}
+
+std::pair<std::size_t, std::size_t> resolve_chunk_span(std::string_view data, std::size_t start, std::size_t end) {
+    end = std::min(end, data.size());
+    if (start >= end) {
+        return {end, end};
+    }
+    const std::size_t begin = start == 0 ? 0 : find_game_start(data, start);
+    if (begin == std::string_view::npos || begin >= end) {
+        return {end, end}; // no game starts inside this range
     }
+    const std::size_t stop = find_game_start(data, end);
+    return {begin, stop == std::string_view::npos ? data.size() : stop};
+}
+
+std::size_t choose_chunk_bytes(std::size_t total_bytes, std::size_t workers) {
+    const std::size_t tasks = std::max<std::size_t>(workers, 1) * kChunksPerWorker;
+    return std::clamp(total_bytes / tasks, kMinChunkBytes, kMaxChunkBytes);
+}
+
+std::vector<ChunkRange> split_pgn_range(const std::filesystem::path& file, std::size_t total, std::size_t chunk_bytes) {
+    return split_pgn_span(file, 0, total, chunk_bytes);
+}
 
+std::vector<ChunkRange> split_pgn_span(const std::filesystem::path& file, std::size_t begin, std::size_t end, std::size_t chunk_bytes) {
+    std::vector<ChunkRange> ranges;
+    chunk_bytes = std::max<std::size_t>(chunk_bytes, 1);
+    if (begin >= end) {
+        return ranges;
+    }
+    ranges.reserve((end - begin) / chunk_bytes + 1);
+    for (std::size_t start = begin; start < end; start += std::min(chunk_bytes, end - start)) {
+        ranges.push_back(ChunkRange{file, start, std::min(start + chunk_bytes, end)});
+    }
     return ranges;
 }
 
+std::vector<ChunkRange> split_pgn_file(const std::filesystem::path& file, std::size_t chunk_bytes) {
+    std::error_code ec;
+    const auto total = std::filesystem::file_size(file, ec);
+    if (ec) {
+        return {};
+    }
+    return split_pgn_range(file, static_cast<std::size_t>(total), chunk_bytes);
+}
+
 } // namespace bayeselo
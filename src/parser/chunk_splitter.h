@@ -2,6 +2,8 @@
 
 #include <filesystem>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace bayeselo {
@@ -12,6 +14,32 @@ struct ChunkRange {
     std::size_t end_offset{0};
 };
 
+// Chunks are raw byte ranges; no game boundaries are searched for up front. A game belongs to the
+// chunk its "[Event" line starts in, so the worker parsing [start, end) resynchronizes to the first
+// game start at or after start and reads past end to finish its last game (see resolve_chunk_span).
 std::vector<ChunkRange> split_pgn_file(const std::filesystem::path& file, std::size_t chunk_bytes);
+// Same, for a file whose size is already known (e.g. from its mapping).
+std::vector<ChunkRange> split_pgn_range(const std::filesystem::path& file, std::size_t total, std::size_t chunk_bytes);
+// Same, for the part [begin, end) of a file; begin and end must be game starts or the file's ends.
+std::vector<ChunkRange> split_pgn_span(const std::filesystem::path& file, std::size_t begin, std::size_t end, std::size_t chunk_bytes);
+
+// Chunk size used when none is given: total_bytes of input split into about kChunksPerWorker tasks
+// per worker, so a few slow chunks still balance, clamped to [kMinChunkBytes, kMaxChunkBytes].
+// Files smaller than the chunk size are batched into shared tasks rather than getting one each.
+inline constexpr std::size_t kChunksPerWorker = 4;
+inline constexpr std::size_t kMinChunkBytes = std::size_t{256} << 10;
+inline constexpr std::size_t kMaxChunkBytes = std::size_t{64} << 20;
+std::size_t choose_chunk_bytes(std::size_t total_bytes, std::size_t workers);
+
+// Game boundaries are lines starting with an "[Event" tag. Offset 0 counts as a line start.
+// Returns the offset of the first game start at or after from, or npos.
+std::size_t find_game_start(std::string_view text, std::size_t from = 0);
+// Returns the offset of the last game start in text, or npos.
+std::size_t find_last_game_start(std::string_view text);
+
+// Text a worker parses for the raw range [start, end) of data: from the first game start at or after
+// start (offset 0 for the first chunk, so a preamble or Event-less file is not lost) to the first game
+// start at or after end, or the end of data. Returns an empty span when no game starts in the range.
+std::pair<std::size_t, std::size_t> resolve_chunk_span(std::string_view data, std::size_t start, std::size_t end);
 
 } // namespace bayeselo
@@ -0,0 +1,155 @@
+#include "filter_program.h"
+
+#include "util/ascii_search.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace bayeselo {
+
+namespace {
+
+char lower(char ch) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+}
+
+std::optional<std::string> lowered(const std::optional<std::string>& value) {
+    if (!value) {
+        return std::nullopt;
+    }
+    std::string out(*value);
+    std::transform(out.begin(), out.end(), out.begin(), lower);
+    return out;
+}
+
+std::optional<GameResult::Outcome> result_outcome(const std::optional<std::string>& filter) {
+    if (!filter) {
+        return std::nullopt;
+    }
+    if (*filter == "1-0") {
+        return GameResult::Outcome::WhiteWin;
+    }
+    if (*filter == "0-1") {
+        return GameResult::Outcome::BlackWin;
+    }
+    if (*filter == "draw" || *filter == "1/2-1/2") {
+        return GameResult::Outcome::Draw;
+    }
+    return std::nullopt; // other values do not filter
+}
+
+std::optional<AhoCorasick> name_list(const std::vector<std::string>& patterns) {
+    if (patterns.empty()) {
+        return std::nullopt;
+    }
+    return AhoCorasick(patterns);
+}
+
+} // namespace
+
+FilterProgram::FilterProgram(const FilterConfig& config)
+    : result_(result_outcome(config.result_filter)),
+      require_complete_(config.require_complete),
+      skip_empty_(config.skip_empty),
+      white_(lowered(config.white_name)),
+      black_(lowered(config.black_name)),
+      either_(lowered(config.either_name)),
+      exclude_(lowered(config.exclude_name)),
+      include_list_(name_list(config.include_names)),
+      exclude_list_(name_list(config.exclude_names)),
+      termination_(lowered(config.termination)),
+      min_plies_(config.min_plies),
+      max_plies_(config.max_plies),
+      min_time_(config.min_time_seconds),
+      max_time_(config.max_time_seconds) {}
+
+std::uint8_t FilterProgram::name_matches(std::string_view name) const {
+    std::uint8_t matches = 0;
+    if (white_ && contains_ascii_nocase(name, *white_)) {
+        matches |= kWhiteMatch;
+    }
+    if (black_ && contains_ascii_nocase(name, *black_)) {
+        matches |= kBlackMatch;
+    }
+    if (either_ && contains_ascii_nocase(name, *either_)) {
+        matches |= kEitherMatch;
+    }
+    if ((exclude_ && contains_ascii_nocase(name, *exclude_)) || (exclude_list_ && exclude_list_->contains_any(name))) {
+        matches |= kExcludeMatch;
+    }
+    if (include_list_ && include_list_->contains_any(name)) {
+        matches |= kIncludeMatch;
+    }
+    return matches;
+}
+
+bool FilterProgram::passes_names(std::uint8_t white_matches, std::uint8_t black_matches) const {
+    const std::uint8_t either = white_matches | black_matches;
+    return !(white_ && !(white_matches & kWhiteMatch)) && !(black_ && !(black_matches & kBlackMatch)) &&
+           !(either_ && !(either & kEitherMatch)) && !(include_list_ && !(either & kIncludeMatch)) && !(either & kExcludeMatch);
+}
+
+bool FilterProgram::passes_outcome(const GameView& game) const {
+    if ((require_complete_ || skip_empty_) && game.outcome == GameResult::Outcome::Unknown) {
+        return false;
+    }
+    if (result_ && game.outcome != *result_) {
+        return false;
+    }
+    return !(require_complete_ && (game.white.empty() || game.black.empty()));
+}
+
+bool FilterProgram::passes_tags(const GameView& game) const {
+    return passes_outcome(game) && passes_names(name_matches(game.white), name_matches(game.black));
+}
+
+bool FilterProgram::passes_termination(std::optional<std::string_view> termination) const {
+    return !termination_ || (termination && contains_ascii_nocase(*termination, *termination_));
+}
+
+FilterProgram::Verdict FilterProgram::time_verdict(const TimeControlResult& spec) const {
+    if (!has_time_filter()) {
+        return Verdict::Accept;
+    }
+    if (!spec) {
+        return Verdict::Reject;
+    }
+    // Estimates only grow with the game's length, so the zero-move estimate is a lower bound.
+    const double shortest = spec->estimate_seconds(0);
+    if (max_time_ && shortest > *max_time_) {
+        return Verdict::Reject;
+    }
+    if (spec->depends_on_plies()) {
+        return Verdict::PerGame;
+    }
+    return passes_time(shortest) ? Verdict::Accept : Verdict::Reject;
+}
+
+bool FilterProgram::passes_time(std::optional<double> duration) const {
+    if (!has_time_filter()) {
+        return true;
+    }
+    if (!duration) {
+        return false;
+    }
+    return !(min_time_ && *duration < *min_time_) && !(max_time_ && *duration > *max_time_);
+}
+
+bool FilterProgram::passes_plies(std::uint32_t plies) const {
+    return !(min_plies_ && plies < *min_plies_) && !(max_plies_ && plies > *max_plies_);
+}
+
+bool FilterProgram::passes(const GameView& game) const {
+    return passes_tags(game) && passes_plies(game.ply_count) && passes_termination(game.termination) &&
+           passes_time(estimated_duration(game));
+}
+
+std::optional<double> estimated_duration(const GameView& game) {
+    if (game.estimated_duration_seconds || !game.time_control) {
+        return game.estimated_duration_seconds;
+    }
+    const auto spec = parse_time_control(*game.time_control);
+    return spec ? std::optional<double>(spec->estimate_seconds(game.ply_count)) : std::nullopt;
+}
+
+} // namespace bayeselo
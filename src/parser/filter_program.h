@@ -0,0 +1,67 @@
+#pragma once
+
+#include "bayeselo/duration.h"
+#include "bayeselo/filters.h"
+#include "bayeselo/game.h"
+#include "util/aho_corasick.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace bayeselo {
+
+// FilterConfig compiled once per run: name and termination needles are lowercased up front and the
+// result filter is resolved to an outcome. Checks are grouped by what they need, so a parser can
+// reject a game from its tags alone before it scans the movetext.
+class FilterProgram {
+public:
+    enum class Verdict : std::uint8_t { Reject, Accept, PerGame };
+
+    explicit FilterProgram(const FilterConfig& config);
+
+    // Bits of the name filters whose needle name contains; depends only on the name, so it can be
+    // worked out once per player.
+    // kExcludeMatch covers --exclude-name and the exclude list; kIncludeMatch is the include list.
+    enum NameMatch : std::uint8_t { kWhiteMatch = 1, kBlackMatch = 2, kEitherMatch = 4, kExcludeMatch = 8, kIncludeMatch = 16 };
+    std::uint8_t name_matches(std::string_view name) const;
+    bool passes_names(std::uint8_t white_matches, std::uint8_t black_matches) const;
+
+    // Outcome and result checks.
+    bool passes_outcome(const GameView& game) const;
+    // passes_outcome plus the player-name checks.
+    bool passes_tags(const GameView& game) const;
+    bool passes_termination(std::optional<std::string_view> termination) const;
+    // The time filters' verdict for every game with this TimeControl; PerGame when the estimate
+    // depends on the game's length and is not already over --max-time at zero moves.
+    Verdict time_verdict(const TimeControlResult& spec) const;
+    bool passes_time(std::optional<double> duration) const;
+    bool passes_plies(std::uint32_t plies) const;
+    // Every check, for a game whose movetext has been scanned.
+    bool passes(const GameView& game) const;
+
+    bool has_time_filter() const { return min_time_ || max_time_; }
+
+private:
+    std::optional<GameResult::Outcome> result_;
+    bool require_complete_{false};
+    bool skip_empty_{false};
+    std::optional<std::string> white_;
+    std::optional<std::string> black_;
+    std::optional<std::string> either_;
+    std::optional<std::string> exclude_;
+    std::optional<AhoCorasick> include_list_;
+    std::optional<AhoCorasick> exclude_list_;
+    std::optional<std::string> termination_;
+    std::optional<std::uint32_t> min_plies_;
+    std::optional<std::uint32_t> max_plies_;
+    std::optional<double> min_time_;
+    std::optional<double> max_time_;
+};
+
+// The game's estimated duration, parsing its TimeControl when the view was not built by a chunk
+// parser (which sets estimated_duration_seconds).
+std::optional<double> estimated_duration(const GameView& game);
+
+} // namespace bayeselo
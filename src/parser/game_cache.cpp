@@ -0,0 +1,324 @@
+#include "game_cache.h"
+
+#include "util/mapped_file.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace bayeselo {
+
+namespace {
+
+// Layout: header, source path, string offsets (string_count + 1), string bytes, records. Every
+// section after the header starts 8-byte aligned.
+constexpr std::array<char, 8> kMagic = {'B', 'E', 'G', 'C', 'A', 'C', 'H', 'E'};
+constexpr std::uint32_t kVersion = 2; // 2: durations include increments and later periods
+constexpr std::uint32_t kNoString = std::numeric_limits<std::uint32_t>::max();
+constexpr std::size_t kTagsPerGame = 6; // white, black, utc_date, utc_time, time_control, termination
+
+struct CacheHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t record_size; // guards against layout changes between builds
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t path_bytes;
+    std::uint64_t string_count;
+    std::uint64_t string_bytes;
+    std::uint64_t game_count;
+};
+
+struct CacheRecord {
+    std::uint32_t tags[kTagsPerGame];
+    std::uint32_t ply_count;
+    std::uint8_t outcome;
+    std::uint8_t has_duration;
+    std::uint8_t padding[2];
+    double duration;
+};
+
+static_assert(std::is_trivially_copyable_v<CacheHeader> && sizeof(CacheHeader) == 64);
+static_assert(std::is_trivially_copyable_v<CacheRecord> && sizeof(CacheRecord) == 40);
+
+constexpr std::size_t align8(std::size_t n) {
+    return (n + 7) & ~std::size_t{7};
+}
+
+std::uint64_t fnv1a(std::string_view text) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char ch : text) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template <typename T>
+bool read_at(std::string_view data, std::size_t offset, T& out) {
+    if (offset > data.size() || data.size() - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&out, data.data() + offset, sizeof(T));
+    return true;
+}
+
+std::array<std::optional<std::string_view>, kTagsPerGame> tags_of(const GameView& game) {
+    return {game.white, game.black, game.utc_date, game.utc_time, game.time_control, game.termination};
+}
+
+bool header_matches(const CacheHeader& header, const GameCacheKey& key) {
+    return header.magic == kMagic && header.version == kVersion && header.record_size == sizeof(CacheRecord) &&
+           header.source_size == key.size && header.source_mtime == key.mtime;
+}
+
+} // namespace
+
+std::optional<GameCacheKey> game_cache_key(const std::filesystem::path& file) {
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(file, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto size = std::filesystem::file_size(absolute, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto mtime = std::filesystem::last_write_time(absolute, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return GameCacheKey{absolute.lexically_normal(), static_cast<std::uint64_t>(size), static_cast<std::int64_t>(mtime.time_since_epoch().count())};
+}
+
+std::filesystem::path game_cache_path(const std::filesystem::path& cache_dir, const GameCacheKey& key) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::uint64_t hash = fnv1a(key.source.string());
+    std::string name(16, '0');
+    for (auto it = name.rbegin(); it != name.rend(); ++it, hash >>= 4) {
+        *it = kHex[hash & 0xf];
+    }
+    return cache_dir / (key.source.filename().string() + "." + name + ".gcache");
+}
+
+bool game_cache_matches(const std::filesystem::path& cache_file, const GameCacheKey& key) {
+    std::ifstream in(cache_file, std::ios::binary);
+    CacheHeader header{};
+    return in.read(reinterpret_cast<char*>(&header), sizeof(header)) && header_matches(header, key);
+}
+
+std::optional<ParsedChunk> load_game_cache(const std::filesystem::path& cache_file, const GameCacheKey& key) {
+    ParsedChunk chunk;
+    std::string_view data;
+    if (auto mapping = MappedFile::open(cache_file)) {
+        data = mapping->view();
+        chunk.mapped = MappedRange(std::move(mapping), 0, data.size());
+    } else {
+        std::ifstream in(cache_file, std::ios::binary | std::ios::ate);
+        if (!in) {
+            return std::nullopt;
+        }
+        chunk.storage.resize(static_cast<std::size_t>(in.tellg()));
+        in.seekg(0);
+        if (!in.read(chunk.storage.data(), static_cast<std::streamsize>(chunk.storage.size()))) {
+            return std::nullopt;
+        }
+        data = std::string_view(chunk.storage.data(), chunk.storage.size());
+    }
+
+    CacheHeader header{};
+    if (!read_at(data, 0, header) || !header_matches(header, key)) {
+        return std::nullopt;
+    }
+    if (header.path_bytes > data.size() || header.string_count > data.size() / sizeof(std::uint64_t) ||
+        header.string_bytes > data.size() || header.game_count > data.size() / sizeof(CacheRecord)) {
+        return std::nullopt;
+    }
+    const std::size_t path_at = sizeof(CacheHeader);
+    const std::size_t offsets_at = align8(path_at + header.path_bytes);
+    const std::size_t strings_at = offsets_at + (header.string_count + 1) * sizeof(std::uint64_t);
+    const std::size_t records_at = align8(strings_at + header.string_bytes);
+    if (records_at > data.size() ||
+        data.size() - records_at != header.game_count * sizeof(CacheRecord) ||
+        data.substr(path_at, header.path_bytes) != key.source.string()) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string_view> strings(header.string_count);
+    std::uint64_t begin = 0;
+    if (!read_at(data, offsets_at, begin)) {
+        return std::nullopt;
+    }
+    for (std::size_t i = 0; i < strings.size(); ++i) {
+        std::uint64_t end = 0;
+        if (!read_at(data, offsets_at + (i + 1) * sizeof(std::uint64_t), end) || end < begin || end > header.string_bytes) {
+            return std::nullopt;
+        }
+        strings[i] = data.substr(strings_at + begin, end - begin);
+        begin = end;
+    }
+
+    chunk.games.resize(header.game_count);
+    for (std::size_t i = 0; i < chunk.games.size(); ++i) {
+        CacheRecord record{};
+        read_at(data, records_at + i * sizeof(CacheRecord), record);
+        std::array<std::optional<std::string_view>, kTagsPerGame> tags;
+        for (std::size_t t = 0; t < kTagsPerGame; ++t) {
+            if (record.tags[t] == kNoString) {
+                continue;
+            }
+            if (record.tags[t] >= strings.size()) {
+                return std::nullopt;
+            }
+            tags[t] = strings[record.tags[t]];
+        }
+        if (record.outcome > static_cast<std::uint8_t>(GameResult::Outcome::Unknown)) {
+            return std::nullopt;
+        }
+        auto& game = chunk.games[i];
+        game.white = tags[0].value_or(std::string_view{});
+        game.black = tags[1].value_or(std::string_view{});
+        game.utc_date = tags[2];
+        game.utc_time = tags[3];
+        game.time_control = tags[4];
+        game.termination = tags[5];
+        game.outcome = static_cast<GameResult::Outcome>(record.outcome);
+        game.ply_count = record.ply_count;
+        if (record.has_duration != 0) {
+            game.estimated_duration_seconds = record.duration;
+        }
+        intern_tags(chunk, game);
+    }
+    return chunk;
+}
+
+GameCacheWriter::GameCacheWriter(std::filesystem::path cache_file, GameCacheKey key, std::size_t chunks)
+    : cache_file_(std::move(cache_file)), key_(std::move(key)), pieces_(chunks), remaining_(chunks) {}
+
+bool GameCacheWriter::add(std::size_t index, const ParsedChunk& chunk) {
+    auto& piece = pieces_[index];
+    std::unordered_map<std::string_view, std::uint32_t> ids;
+    piece.tags.reserve(chunk.games.size() * kTagsPerGame);
+    piece.plies.reserve(chunk.games.size());
+    piece.outcomes.reserve(chunk.games.size());
+    piece.durations.reserve(chunk.games.size());
+    for (const auto& game : chunk.games) {
+        for (const auto& tag : tags_of(game)) {
+            if (!tag) {
+                piece.tags.push_back(kNoString);
+                continue;
+            }
+            auto [it, inserted] = ids.try_emplace(*tag, static_cast<std::uint32_t>(piece.strings.size()));
+            if (inserted) {
+                piece.strings.emplace_back(*tag);
+            }
+            piece.tags.push_back(it->second);
+        }
+        piece.plies.push_back(game.ply_count);
+        piece.outcomes.push_back(static_cast<std::uint8_t>(game.outcome));
+        piece.durations.push_back(game.estimated_duration_seconds);
+    }
+    return finish_one();
+}
+
+bool GameCacheWriter::abandon(std::size_t index) {
+    pieces_[index] = Piece{};
+    abandoned_.store(true, std::memory_order_relaxed);
+    return finish_one();
+}
+
+bool GameCacheWriter::finish_one() {
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1 || abandoned_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    return write();
+}
+
+bool GameCacheWriter::write() const {
+    // Merge the chunk-local string tables in chunk order so the cache is the same however the
+    // chunks were scheduled.
+    std::unordered_map<std::string_view, std::uint32_t> ids;
+    std::vector<std::string_view> strings;
+    std::vector<std::vector<std::uint32_t>> remap(pieces_.size());
+    std::uint64_t string_bytes = 0;
+    std::uint64_t game_count = 0;
+    for (std::size_t p = 0; p < pieces_.size(); ++p) {
+        for (const auto& value : pieces_[p].strings) {
+            auto [it, inserted] = ids.try_emplace(value, static_cast<std::uint32_t>(strings.size()));
+            if (inserted) {
+                strings.push_back(value);
+                string_bytes += value.size();
+            }
+            remap[p].push_back(it->second);
+        }
+        game_count += pieces_[p].plies.size();
+    }
+    if (strings.size() >= kNoString) {
+        return false;
+    }
+
+    const std::string source = key_.source.string();
+    CacheHeader header{kMagic, kVersion, sizeof(CacheRecord), key_.size, key_.mtime, source.size(), strings.size(), string_bytes, game_count};
+    std::vector<char> out(sizeof(CacheHeader));
+    std::memcpy(out.data(), &header, sizeof(header));
+    auto append = [&](const void* bytes, std::size_t size) {
+        const auto* first = static_cast<const char*>(bytes);
+        out.insert(out.end(), first, first + size);
+    };
+    append(source.data(), source.size());
+    out.resize(align8(out.size()));
+    std::uint64_t offset = 0;
+    append(&offset, sizeof(offset));
+    for (const auto& value : strings) {
+        offset += value.size();
+        append(&offset, sizeof(offset));
+    }
+    for (const auto& value : strings) {
+        append(value.data(), value.size());
+    }
+    out.resize(align8(out.size()));
+    out.reserve(out.size() + game_count * sizeof(CacheRecord));
+    for (std::size_t p = 0; p < pieces_.size(); ++p) {
+        const auto& piece = pieces_[p];
+        for (std::size_t g = 0; g < piece.plies.size(); ++g) {
+            CacheRecord record{};
+            for (std::size_t t = 0; t < kTagsPerGame; ++t) {
+                const auto local = piece.tags[g * kTagsPerGame + t];
+                record.tags[t] = local == kNoString ? kNoString : remap[p][local];
+            }
+            record.ply_count = piece.plies[g];
+            record.outcome = piece.outcomes[g];
+            record.has_duration = piece.durations[g].has_value() ? 1 : 0;
+            record.duration = piece.durations[g].value_or(0.0);
+            append(&record, sizeof(record));
+        }
+    }
+
+    // Write to a temporary file and rename it over the cache, so readers never see a partial file.
+    auto temp = cache_file_;
+    temp += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(out.data(), static_cast<std::streamsize>(out.size())) || !file.flush()) {
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, cache_file_, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace bayeselo
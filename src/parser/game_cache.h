@@ -0,0 +1,69 @@
+#pragma once
+
+#include "parser/pgn_parser.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bayeselo {
+
+// Identifies the PGN file a cache was built from; a cache is only used while all three still match.
+struct GameCacheKey {
+    std::filesystem::path source; // absolute
+    std::uint64_t size{0};
+    std::int64_t mtime{0}; // file_time_type ticks
+};
+
+std::optional<GameCacheKey> game_cache_key(const std::filesystem::path& file);
+// Cache file for key inside cache_dir, named after a hash of the source path.
+std::filesystem::path game_cache_path(const std::filesystem::path& cache_dir, const GameCacheKey& key);
+
+// Cheap check of the cache header against key, without reading the games.
+bool game_cache_matches(const std::filesystem::path& cache_file, const GameCacheKey& key);
+// Loads every game of the cached source. Returns nullopt when the cache is missing, was built from
+// a different version of the source, or is damaged. The views point into the mapped cache file
+// (tags are interned there, so repeated names share one string); moves are never cached.
+std::optional<ParsedChunk> load_game_cache(const std::filesystem::path& cache_file, const GameCacheKey& key);
+
+// Collects the games of one source file from the chunks it was parsed in, in any order and from any
+// thread, and writes the cache once the last of the expected chunks is in. Chunks must be added
+// unfiltered so the cache holds every game. If any chunk is abandoned (failed to parse), no cache
+// is written.
+class GameCacheWriter {
+public:
+    GameCacheWriter(std::filesystem::path cache_file, GameCacheKey key, std::size_t chunks);
+    GameCacheWriter(const GameCacheWriter&) = delete;
+    GameCacheWriter& operator=(const GameCacheWriter&) = delete;
+
+    // Both return false only when this was the last chunk and the cache could not be written.
+    bool add(std::size_t index, const ParsedChunk& chunk);
+    bool abandon(std::size_t index);
+
+    const std::filesystem::path& cache_file() const { return cache_file_; }
+
+private:
+    // One chunk's games with their tags interned into a chunk-local string table.
+    struct Piece {
+        std::vector<std::string> strings;
+        std::vector<std::uint32_t> tags; // kTagsPerGame string ids per game
+        std::vector<std::uint32_t> plies;
+        std::vector<std::uint8_t> outcomes;
+        std::vector<std::optional<double>> durations;
+    };
+
+    bool finish_one();
+    bool write() const;
+
+    std::filesystem::path cache_file_;
+    GameCacheKey key_;
+    std::vector<Piece> pieces_;
+    std::atomic_size_t remaining_;
+    std::atomic_bool abandoned_{false};
+};
+
+} // namespace bayeselo
@@ -0,0 +1,140 @@
+#include "game_index.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+namespace bayeselo {
+
+namespace {
+
+constexpr std::array<char, 8> kMagic = {'B', 'E', 'P', 'G', 'N', 'I', 'D', 'X'};
+constexpr std::uint32_t kVersion = 1;
+
+struct IndexHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t game_count;
+};
+
+static_assert(std::is_trivially_copyable_v<IndexHeader> && sizeof(IndexHeader) == 40);
+
+} // namespace
+
+std::filesystem::path game_index_path(const std::filesystem::path& pgn_file) {
+    auto index = pgn_file;
+    index += ".pgnidx";
+    return index;
+}
+
+std::optional<GameIndex> load_game_index(const std::filesystem::path& index_file, const GameCacheKey& key) {
+    std::ifstream in(index_file, std::ios::binary);
+    IndexHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != kMagic || header.version != kVersion ||
+        header.source_size != key.size || header.source_mtime != key.mtime || header.game_count > key.size + 1) {
+        return std::nullopt;
+    }
+    GameIndex index;
+    index.file_size = header.source_size;
+    index.offsets.resize(header.game_count);
+    if (!in.read(reinterpret_cast<char*>(index.offsets.data()), static_cast<std::streamsize>(index.offsets.size() * sizeof(std::uint64_t))) ||
+        in.peek() != std::ifstream::traits_type::eof()) {
+        return std::nullopt;
+    }
+    if (!index.offsets.empty() && index.offsets.front() != 0) {
+        return std::nullopt;
+    }
+    for (std::size_t i = 1; i < index.offsets.size(); ++i) {
+        if (index.offsets[i] <= index.offsets[i - 1] || index.offsets[i] >= index.file_size) {
+            return std::nullopt;
+        }
+    }
+    return index;
+}
+
+std::vector<std::uint64_t> find_game_starts(std::string_view data, std::size_t start, std::size_t end) {
+    std::vector<std::uint64_t> starts;
+    end = std::min(end, data.size());
+    for (std::size_t pos = find_game_start(data, start); pos != std::string_view::npos && pos < end; pos = find_game_start(data, pos + 1)) {
+        starts.push_back(pos);
+    }
+    return starts;
+}
+
+std::vector<ChunkRange> split_pgn_index(const std::filesystem::path& file, const GameIndex& index, std::size_t chunks) {
+    std::vector<ChunkRange> ranges;
+    const std::size_t games = index.game_count();
+    if (games == 0) {
+        return ranges;
+    }
+    chunks = std::clamp<std::size_t>(chunks, 1, games);
+    ranges.reserve(chunks);
+    for (std::size_t c = 0; c < chunks; ++c) {
+        const std::size_t first = games * c / chunks;
+        const std::size_t last = games * (c + 1) / chunks; // exclusive
+        ranges.push_back(ChunkRange{file, index.game_span(first).first, last < games ? index.game_span(last).first : static_cast<std::size_t>(index.file_size)});
+    }
+    return ranges;
+}
+
+GameIndexWriter::GameIndexWriter(std::filesystem::path index_file, GameCacheKey key, std::size_t ranges)
+    : index_file_(std::move(index_file)), key_(std::move(key)), starts_(ranges), remaining_(ranges) {}
+
+bool GameIndexWriter::add(std::size_t range, std::vector<std::uint64_t> starts) {
+    starts_[range] = std::move(starts);
+    return finish_one();
+}
+
+bool GameIndexWriter::abandon(std::size_t range) {
+    starts_[range].clear();
+    abandoned_.store(true, std::memory_order_relaxed);
+    return finish_one();
+}
+
+bool GameIndexWriter::finish_one() {
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1 || abandoned_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    return write();
+}
+
+bool GameIndexWriter::write() const {
+    std::vector<std::uint64_t> offsets;
+    for (const auto& starts : starts_) {
+        offsets.insert(offsets.end(), starts.begin(), starts.end());
+    }
+    // The first game owns any preamble; a file without "[Event" lines is indexed as one game.
+    if (!offsets.empty()) {
+        offsets.front() = 0;
+    } else if (key_.size > 0) {
+        offsets.push_back(0);
+    }
+    const IndexHeader header{kMagic, kVersion, 0, key_.size, key_.mtime, offsets.size()};
+    auto temp = index_file_;
+    temp += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t)));
+        if (!out.flush()) {
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, index_file_, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace bayeselo
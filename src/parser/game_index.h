@@ -0,0 +1,67 @@
+#pragma once
+
+#include "parser/chunk_splitter.h"
+#include "parser/game_cache.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bayeselo {
+
+// Byte offset of every game in a PGN file, as stored in its ".pgnidx" sidecar. offsets[0] is 0 so
+// any preamble stays with the first game, as it does for the first raw chunk (resolve_chunk_span).
+struct GameIndex {
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t file_size{0};
+
+    std::size_t game_count() const { return offsets.size(); }
+    // Byte range of game n: O(1), no scanning.
+    std::pair<std::size_t, std::size_t> game_span(std::size_t n) const {
+        return {static_cast<std::size_t>(offsets[n]), static_cast<std::size_t>(n + 1 < offsets.size() ? offsets[n + 1] : file_size)};
+    }
+};
+
+// "<file>.pgnidx", next to the PGN file.
+std::filesystem::path game_index_path(const std::filesystem::path& pgn_file);
+
+// Loads the index for the source identified by key; nullopt when missing, stale or damaged.
+std::optional<GameIndex> load_game_index(const std::filesystem::path& index_file, const GameCacheKey& key);
+
+// Game starts g with start <= g < end.
+std::vector<std::uint64_t> find_game_starts(std::string_view data, std::size_t start, std::size_t end);
+
+// Splits the indexed games of file into about `chunks` ranges holding the same number of games each.
+std::vector<ChunkRange> split_pgn_index(const std::filesystem::path& file, const GameIndex& index, std::size_t chunks);
+
+// Collects game starts from the raw ranges of one file, in any order and from any thread, and writes
+// the sidecar once the last range is in. An abandoned range means no index is written.
+class GameIndexWriter {
+public:
+    GameIndexWriter(std::filesystem::path index_file, GameCacheKey key, std::size_t ranges);
+    GameIndexWriter(const GameIndexWriter&) = delete;
+    GameIndexWriter& operator=(const GameIndexWriter&) = delete;
+
+    // Both return false only when this was the last range and the index could not be written.
+    bool add(std::size_t range, std::vector<std::uint64_t> starts);
+    bool abandon(std::size_t range);
+
+    const std::filesystem::path& index_file() const { return index_file_; }
+
+private:
+    bool finish_one();
+    bool write() const;
+
+    std::filesystem::path index_file_;
+    GameCacheKey key_;
+    std::vector<std::vector<std::uint64_t>> starts_;
+    std::atomic_size_t remaining_;
+    std::atomic_bool abandoned_{false};
+};
+
+} // namespace bayeselo
@@ -0,0 +1,346 @@
+#include "gzip_reader.h"
+
+#include "chunk_splitter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef BAYESELO_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace bayeselo {
+
+namespace {
+
+constexpr unsigned char kGzipId1 = 0x1f;
+constexpr unsigned char kGzipId2 = 0x8b;
+constexpr unsigned char kGzipFlagExtra = 0x04;
+constexpr std::size_t kGzipHeaderBytes = 12; // fixed header + XLEN
+constexpr std::size_t kGzipTrailerBytes = 8; // CRC32 + ISIZE
+constexpr std::size_t kStreamBufferBytes = 1u << 16;
+
+std::uint32_t read_le16(std::string_view data, std::size_t pos) {
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(data[pos])) |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(data[pos + 1])) << 8;
+}
+
+std::uint32_t read_le32(std::string_view data, std::size_t pos) {
+    return read_le16(data, pos) | read_le16(data, pos + 2) << 16;
+}
+
+// Member size from the BGZF "BC" extra subfield, or 0 when the member at pos is not BGZF.
+std::size_t bgzf_member_size(std::string_view data, std::size_t pos) {
+    if (data.size() - pos < kGzipHeaderBytes || !is_gzip_data(data.substr(pos)) || data[pos + 2] != 8 ||
+        (static_cast<unsigned char>(data[pos + 3]) & kGzipFlagExtra) == 0) {
+        return 0;
+    }
+    const std::size_t xlen = read_le16(data, pos + 10);
+    std::size_t field = pos + kGzipHeaderBytes;
+    const std::size_t extra_end = field + xlen;
+    if (extra_end > data.size()) {
+        return 0;
+    }
+    while (field + 4 <= extra_end) {
+        const std::size_t slen = read_le16(data, field + 2);
+        if (data[field] == 'B' && data[field + 1] == 'C' && slen == 2 && field + 6 <= extra_end) {
+            return static_cast<std::size_t>(read_le16(data, field + 4)) + 1;
+        }
+        field += 4 + slen;
+    }
+    return 0;
+}
+
+} // namespace
+
+bool gzip_supported() {
+#ifdef BAYESELO_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool is_gzip_data(std::string_view data) {
+    return data.size() >= 2 && static_cast<unsigned char>(data[0]) == kGzipId1 && static_cast<unsigned char>(data[1]) == kGzipId2;
+}
+
+bool is_gzip_file(const std::filesystem::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    char magic[2] = {};
+    if (!in.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return is_gzip_data(std::string_view(magic, sizeof(magic)));
+}
+
+std::vector<GzipMember> scan_bgzf_members(std::string_view data) {
+    std::vector<GzipMember> members;
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        const std::size_t size = bgzf_member_size(data, pos);
+        if (size < kGzipHeaderBytes + kGzipTrailerBytes || size > data.size() - pos) {
+            return {};
+        }
+        members.push_back(GzipMember{pos, size, read_le32(data, pos + size - 4)});
+        pos += size;
+    }
+    return members;
+}
+
+#ifdef BAYESELO_HAVE_ZLIB
+
+bool inflate_gzip(std::string_view compressed, std::vector<char>& out) {
+    z_stream zs{};
+    if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) {
+        return false;
+    }
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    zs.avail_in = static_cast<uInt>(compressed.size());
+    bool ok = true;
+    while (true) {
+        if (out.size() == out.capacity()) {
+            out.reserve(std::max<std::size_t>(out.capacity() * 2, compressed.size() * 4 + 1024));
+        }
+        const std::size_t filled = out.size();
+        out.resize(out.capacity());
+        zs.next_out = reinterpret_cast<Bytef*>(out.data() + filled);
+        zs.avail_out = static_cast<uInt>(out.size() - filled);
+        const int rc = inflate(&zs, Z_NO_FLUSH);
+        out.resize(out.size() - zs.avail_out);
+        if (rc == Z_STREAM_END) {
+            if (zs.avail_in == 0) {
+                break;
+            }
+            inflateReset(&zs); // next member of a multi-member file
+            continue;
+        }
+        if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            ok = false;
+            break;
+        }
+        if (rc == Z_BUF_ERROR && zs.avail_in == 0) {
+            ok = false; // truncated input
+            break;
+        }
+    }
+    inflateEnd(&zs);
+    return ok;
+}
+
+struct GzipStreambuf::State {
+    z_stream zs{};
+    bool source_done{false};
+    bool between_members{true};
+};
+
+GzipStreambuf::GzipStreambuf(std::istream& source)
+    : source_(source), state_(std::make_unique<State>()), in_buf_(kStreamBufferBytes), out_buf_(kStreamBufferBytes) {
+    if (inflateInit2(&state_->zs, 16 + MAX_WBITS) != Z_OK) {
+        throw std::runtime_error("zlib initialisation failed");
+    }
+    setg(out_buf_.data(), out_buf_.data(), out_buf_.data());
+}
+
+GzipStreambuf::~GzipStreambuf() {
+    inflateEnd(&state_->zs);
+}
+
+GzipStreambuf::int_type GzipStreambuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    auto& zs = state_->zs;
+    while (true) {
+        if (zs.avail_in == 0 && !state_->source_done) {
+            source_.read(in_buf_.data(), static_cast<std::streamsize>(in_buf_.size()));
+            zs.next_in = reinterpret_cast<Bytef*>(in_buf_.data());
+            zs.avail_in = static_cast<uInt>(source_.gcount());
+            if (!source_) {
+                state_->source_done = true;
+            }
+        }
+        if (zs.avail_in == 0 && state_->source_done) {
+            if (!state_->between_members) {
+                throw std::runtime_error("truncated gzip stream");
+            }
+            return traits_type::eof();
+        }
+        zs.next_out = reinterpret_cast<Bytef*>(out_buf_.data());
+        zs.avail_out = static_cast<uInt>(out_buf_.size());
+        const int rc = inflate(&zs, Z_NO_FLUSH);
+        if (rc == Z_STREAM_END) {
+            inflateReset(&zs); // a multi-member file continues with the next gzip header
+            state_->between_members = true;
+        } else if (rc == Z_OK || rc == Z_BUF_ERROR) {
+            state_->between_members = false;
+        } else {
+            throw std::runtime_error("corrupt gzip stream");
+        }
+        const std::size_t produced = out_buf_.size() - zs.avail_out;
+        if (produced > 0) {
+            setg(out_buf_.data(), out_buf_.data(), out_buf_.data() + produced);
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+}
+
+#else
+
+bool inflate_gzip(std::string_view, std::vector<char>&) {
+    return false;
+}
+
+struct GzipStreambuf::State {};
+
+GzipStreambuf::GzipStreambuf(std::istream& source) : source_(source) {
+    throw std::runtime_error("gzip input requires a build with zlib");
+}
+
+GzipStreambuf::~GzipStreambuf() = default;
+
+GzipStreambuf::int_type GzipStreambuf::underflow() {
+    return traits_type::eof();
+}
+
+#endif
+
+namespace {
+
+// Per-file state shared by the group tasks of one BGZF file. Each group parses the games that start
+// and end inside it; the partial game before its first boundary (head) and the one from its last
+// boundary onwards (tail) are kept for the stitching pass run by the last group to finish.
+struct BgzfFileState {
+    struct Edges {
+        std::vector<char> head;
+        std::vector<char> tail;
+        bool has_boundary{false};
+        bool lost{false}; // failed to inflate: no game may be stitched across it
+    };
+    std::shared_ptr<const MappedFile> file;
+    std::vector<std::vector<GzipMember>> groups;
+    std::vector<Edges> edges;
+    std::atomic_size_t remaining{0};
+    std::atomic_bool failed{false};
+    ParseOptions options;
+    ParsedChunkSink sink;
+    std::function<void(std::string_view)> on_error;
+};
+
+// Group i's interior is piece 2 * i + 1; a stitched piece ending at group i's first boundary is
+// piece 2 * i, and the piece after the last boundary comes last.
+void stitch_group_edges(BgzfFileState& state) {
+    std::vector<char> carry;
+    auto flush = [&](std::vector<char>& piece, std::size_t order) {
+        if (!piece.empty()) {
+            auto parsed = parse_pgn_buffer(std::move(piece), state.options);
+            state.sink(parsed, order);
+        }
+        piece = {};
+    };
+    // After a lost group, text up to the next boundary is the rest of a game whose start is gone.
+    bool after_gap = false;
+    for (std::size_t i = 0; i < state.edges.size(); ++i) {
+        auto& edges = state.edges[i];
+        if (edges.lost) {
+            carry.clear(); // the game it starts is cut off by the gap
+            after_gap = true;
+            continue;
+        }
+        if (!after_gap) {
+            carry.insert(carry.end(), edges.head.begin(), edges.head.end());
+        }
+        if (edges.has_boundary) {
+            flush(carry, 2 * i);
+            carry = std::move(edges.tail);
+            after_gap = false;
+        }
+    }
+    flush(carry, 2 * state.edges.size());
+}
+
+void process_bgzf_group(const std::shared_ptr<BgzfFileState>& state, std::size_t index) {
+    const auto& group = state->groups[index];
+    std::vector<char> text;
+    std::size_t expected = 0;
+    for (const auto& member : group) {
+        expected += member.uncompressed_size;
+    }
+    text.reserve(expected);
+    const auto data = state->file->view();
+    const std::size_t begin = group.front().offset;
+    const std::size_t end = group.back().offset + group.back().size;
+    if (!inflate_gzip(data.substr(begin, end - begin), text)) {
+        if (!state->failed.exchange(true, std::memory_order_relaxed) && state->on_error) {
+            state->on_error("corrupt BGZF block at offset " + std::to_string(begin));
+        }
+        text.clear();
+        state->edges[index].lost = true;
+    }
+    state->file->release(begin, end);
+
+    auto& edges = state->edges[index];
+    const std::string_view view(text.data(), text.size());
+    const std::size_t first = find_game_start(view);
+    if (first == std::string_view::npos) {
+        edges.head = std::move(text); // a single game spans this whole group
+    } else {
+        const std::size_t last = find_last_game_start(view);
+        edges.has_boundary = true;
+        edges.head.assign(text.begin(), text.begin() + static_cast<std::ptrdiff_t>(first));
+        edges.tail.assign(text.begin() + static_cast<std::ptrdiff_t>(last), text.end());
+        text.resize(last);
+        text.erase(text.begin(), text.begin() + static_cast<std::ptrdiff_t>(first));
+        if (!text.empty()) {
+            auto parsed = parse_pgn_buffer(std::move(text), state->options);
+            state->sink(parsed, 2 * index + 1);
+        }
+    }
+
+    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        stitch_group_edges(*state);
+    }
+}
+
+} // namespace
+
+void enqueue_bgzf_file(ThreadPool& pool,
+                       std::shared_ptr<const MappedFile> file,
+                       std::vector<GzipMember> members,
+                       std::size_t chunk_bytes,
+                       const ParseOptions& options,
+                       ParsedChunkSink sink,
+                       std::function<void(std::string_view)> on_error) {
+    if (members.empty()) {
+        return;
+    }
+    auto state = std::make_shared<BgzfFileState>();
+    state->file = std::move(file);
+    state->options = options;
+    state->sink = std::move(sink);
+    state->on_error = std::move(on_error);
+    std::size_t group_bytes = 0;
+    for (const auto& member : members) {
+        if (state->groups.empty() || group_bytes >= chunk_bytes) {
+            state->groups.emplace_back();
+            group_bytes = 0;
+        }
+        state->groups.back().push_back(member);
+        group_bytes += member.uncompressed_size;
+    }
+    state->edges.resize(state->groups.size());
+    state->remaining.store(state->groups.size(), std::memory_order_relaxed);
+    std::vector<Task> tasks;
+    tasks.reserve(state->groups.size());
+    for (std::size_t i = 0; i < state->groups.size(); ++i) {
+        tasks.emplace_back([state, i]() { process_bgzf_group(state, i); });
+    }
+    pool.enqueue_bulk(std::move(tasks));
+}
+
+} // namespace bayeselo
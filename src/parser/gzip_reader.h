@@ -0,0 +1,74 @@
+#pragma once
+
+#include "parser/pgn_parser.h"
+#include "util/mapped_file.h"
+#include "util/thread_pool.h"
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+
+namespace bayeselo {
+
+// True when the library was built with zlib and can read .pgn.gz inputs.
+bool gzip_supported();
+
+// gzip magic bytes (1f 8b) at the start of data / of the file.
+bool is_gzip_data(std::string_view data);
+bool is_gzip_file(const std::filesystem::path& file);
+
+// One independently decompressible BGZF member.
+struct GzipMember {
+    std::size_t offset{0};
+    std::size_t size{0};
+    std::size_t uncompressed_size{0}; // ISIZE trailer
+};
+
+// Splits BGZF data (gzip members carrying a "BC" extra subfield with the member size, as written by
+// bgzip) into its members without decompressing. Returns an empty vector when data is not BGZF.
+std::vector<GzipMember> scan_bgzf_members(std::string_view data);
+
+// Inflates one or more concatenated gzip members, appending to out. Returns false on corrupt input.
+bool inflate_gzip(std::string_view compressed, std::vector<char>& out);
+
+// istream buffer that inflates a (possibly multi-member) gzip stream read from source. Corrupt
+// input throws from underflow, which the reading istream reports as badbit.
+class GzipStreambuf : public std::streambuf {
+public:
+    explicit GzipStreambuf(std::istream& source);
+    ~GzipStreambuf() override;
+    GzipStreambuf(const GzipStreambuf&) = delete;
+    GzipStreambuf& operator=(const GzipStreambuf&) = delete;
+
+protected:
+    int_type underflow() override;
+
+private:
+    struct State;
+    std::istream& source_;
+    std::unique_ptr<State> state_;
+    std::vector<char> in_buf_;
+    std::vector<char> out_buf_;
+};
+
+// Receives each parsed piece of a BGZF file with its position in the file: pieces sorted by order
+// come out in the order their games appear in the decompressed text.
+using ParsedChunkSink = std::function<void(const ParsedChunk&, std::size_t order)>;
+
+// Decompresses BGZF member groups of roughly chunk_bytes (uncompressed) in parallel on pool and
+// parses them as they finish. Games that straddle group boundaries are stitched together and parsed
+// once the last group of the file is done. Returns immediately; completion is tracked by the pool.
+// on_error is called at most once per file, with a description, when a block fails to inflate.
+void enqueue_bgzf_file(ThreadPool& pool,
+                       std::shared_ptr<const MappedFile> file,
+                       std::vector<GzipMember> members,
+                       std::size_t chunk_bytes,
+                       const ParseOptions& options,
+                       ParsedChunkSink sink,
+                       std::function<void(std::string_view)> on_error);
+
+} // namespace bayeselo
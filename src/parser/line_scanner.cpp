@@ -0,0 +1,109 @@
+#include "line_scanner.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BAYESELO_LINE_SCANNER_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define BAYESELO_LINE_SCANNER_AVX2 1
+#endif
+#endif
+
+namespace bayeselo {
+
+namespace {
+
+// C-locale isspace: ' ' and '\t' '\n' '\v' '\f' '\r' (0x09-0x0D).
+constexpr bool is_space_byte(unsigned char ch) {
+    return ch == ' ' || static_cast<unsigned char>(ch - '\t') <= '\r' - '\t';
+}
+
+[[maybe_unused]] LineBlockMasks classify_scalar(const char* data) {
+    LineBlockMasks masks;
+    for (std::size_t i = 0; i < kLineBlockBytes; ++i) {
+        const auto ch = static_cast<unsigned char>(data[i]);
+        masks.newline |= static_cast<std::uint64_t>(ch == '\n') << i;
+        masks.content |= static_cast<std::uint64_t>(!is_space_byte(ch)) << i;
+    }
+    return masks;
+}
+
+#ifdef BAYESELO_LINE_SCANNER_X86
+LineBlockMasks classify_sse2(const char* data) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i span = _mm_set1_epi8('\r' - '\t');
+    LineBlockMasks masks;
+    for (std::size_t i = 0; i < kLineBlockBytes; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // (byte - '\t') <= 4 as unsigned: min(x, 4) == x.
+        const __m128i shifted = _mm_sub_epi8(bytes, tab);
+        const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, span), shifted);
+        const __m128i whitespace = _mm_or_si128(control, _mm_cmpeq_epi8(bytes, space));
+        const auto nl_bits = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+        const auto ws_bits = static_cast<std::uint32_t>(_mm_movemask_epi8(whitespace));
+        masks.newline |= static_cast<std::uint64_t>(nl_bits) << i;
+        masks.content |= static_cast<std::uint64_t>(~ws_bits & 0xFFFFu) << i;
+    }
+    return masks;
+}
+
+#endif
+
+#ifdef BAYESELO_LINE_SCANNER_AVX2
+__attribute__((target("avx2"))) LineBlockMasks classify_avx2(const char* data) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i span = _mm256_set1_epi8('\r' - '\t');
+    LineBlockMasks masks;
+    for (std::size_t i = 0; i < kLineBlockBytes; i += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i shifted = _mm256_sub_epi8(bytes, tab);
+        const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, span), shifted);
+        const __m256i whitespace = _mm256_or_si256(control, _mm256_cmpeq_epi8(bytes, space));
+        const auto nl_bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newline)));
+        const auto ws_bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(whitespace));
+        masks.newline |= static_cast<std::uint64_t>(nl_bits) << i;
+        masks.content |= static_cast<std::uint64_t>(~ws_bits) << i;
+    }
+    return masks;
+}
+#endif
+
+using ClassifyFn = LineBlockMasks (*)(const char*);
+
+struct Backend {
+    ClassifyFn classify;
+    std::string_view name;
+};
+
+Backend select_backend() {
+#ifdef BAYESELO_LINE_SCANNER_X86
+#ifdef BAYESELO_LINE_SCANNER_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return {classify_avx2, "avx2"};
+    }
+#endif
+    return {classify_sse2, "sse2"}; // SSE2 is part of the x86-64 baseline
+#else
+    return {classify_scalar, "scalar"};
+#endif
+}
+
+const Backend& backend() {
+    static const Backend selected = select_backend();
+    return selected;
+}
+
+} // namespace
+
+LineBlockMasks classify_line_block(const char* data) {
+    return backend().classify(data);
+}
+
+std::string_view line_scanner_backend() {
+    return backend().name;
+}
+
+} // namespace bayeselo
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace bayeselo {
+
+// Classification of one 64-byte block: bit i is set when byte i is '\n' (newline) or is not
+// C-locale whitespace (content).
+struct LineBlockMasks {
+    std::uint64_t newline{0};
+    std::uint64_t content{0};
+};
+
+inline constexpr std::size_t kLineBlockBytes = 64;
+
+// Classifies exactly kLineBlockBytes bytes at data. Dispatches once to AVX2, SSE2 or a scalar
+// fallback depending on what the CPU supports.
+LineBlockMasks classify_line_block(const char* data);
+
+// Name of the block classifier selected for this CPU ("avx2", "sse2" or "scalar").
+std::string_view line_scanner_backend();
+
+// Calls fn(line, blank) for every line in text. line excludes the '\n' and a trailing '\r';
+// blank is true when the line is empty or contains only whitespace. A final line without a
+// terminating newline is reported too; a trailing newline does not produce an extra empty line.
+template <typename Fn>
+void for_each_line(std::string_view text, Fn&& fn) {
+    const char* base = text.data();
+    const std::size_t size = text.size();
+    std::size_t line_start = 0;
+    bool line_has_content = false;
+
+    auto emit = [&](std::size_t begin, std::size_t end, bool blank) {
+        std::string_view line(base + begin, end - begin);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        fn(line, blank);
+    };
+
+    for (std::size_t block = 0; block < size; block += kLineBlockBytes) {
+        LineBlockMasks masks;
+        const std::size_t avail = size - block;
+        if (avail >= kLineBlockBytes) {
+            masks = classify_line_block(base + block);
+        } else {
+            // Pad the tail with spaces: whitespace that is neither newline nor content.
+            char tail[kLineBlockBytes];
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, base + block, avail);
+            masks = classify_line_block(tail);
+        }
+
+        // Bits at or after the start of the current line within this block.
+        std::uint64_t line_mask = line_start > block ? (~std::uint64_t{0} << (line_start - block)) : ~std::uint64_t{0};
+        std::uint64_t newlines = masks.newline;
+        while (newlines != 0) {
+            const unsigned bit = static_cast<unsigned>(std::countr_zero(newlines));
+            const std::uint64_t before = bit == 0 ? 0 : (~std::uint64_t{0} >> (kLineBlockBytes - bit));
+            const bool content = line_has_content || (masks.content & line_mask & before) != 0;
+            const std::size_t line_end = block + bit;
+            emit(line_start, line_end, !content);
+            line_start = line_end + 1;
+            line_has_content = false;
+            line_mask = bit == kLineBlockBytes - 1 ? 0 : (~std::uint64_t{0} << (bit + 1));
+            newlines &= newlines - 1;
+        }
+        line_has_content = line_has_content || (masks.content & line_mask) != 0;
+    }
+    if (line_start < size) {
+        emit(line_start, size, !line_has_content);
+    }
+}
+
+} // namespace bayeselo
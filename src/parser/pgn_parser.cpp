@@ -1,10 +1,12 @@
 #include "pgn_parser.h"
 
 #include "bayeselo/duration.h"
+#include "chunk_splitter.h"
+#include "line_scanner.h"
 
 #include <algorithm>
 #include <cctype>
-#include <exception>
+#include <cstdint>
 #include <fstream>
 #include <optional>
 #include <string_view>
@@ -14,80 +16,201 @@
 namespace bayeselo {
 
 namespace {
-std::optional<std::string> parse_tag_line(std::string_view line) {
+std::optional<std::string_view> parse_tag_line(std::string_view line) {
     if (line.size() < 2 || line.front() != '[' || line.back() != ']') {
         return std::nullopt;
     }
-    return std::string(line.substr(1, line.size() - 2));
+    return line.substr(1, line.size() - 2);
 }
 
-std::pair<std::string, std::string> split_tag(std::string_view tag_line) {
-    auto space = tag_line.find(' ');
-    if (space == std::string_view::npos) {
-        return {std::string(tag_line), {}};
+// Tags the parser keeps. Everything else (Event, Site, Round, WhiteElo, Opening, ...) is Other.
+enum class TagKind : std::uint8_t { Other, White, Black, Result, Termination, UtcDate, UtcTime, TimeControl };
+
+// Dispatches on key length first, so most unneeded tags are rejected without a single compare.
+constexpr TagKind classify_tag(std::string_view key) {
+    switch (key.size()) {
+    case 5:
+        return key == "White" ? TagKind::White : key == "Black" ? TagKind::Black : TagKind::Other;
+    case 6:
+        return key == "Result" ? TagKind::Result : TagKind::Other;
+    case 7:
+        if (!key.starts_with("UTC")) {
+            return TagKind::Other;
+        }
+        return key == "UTCDate" ? TagKind::UtcDate : key == "UTCTime" ? TagKind::UtcTime : TagKind::Other;
+    case 11:
+        return key == "Termination" ? TagKind::Termination : key == "TimeControl" ? TagKind::TimeControl : TagKind::Other;
+    default:
+        return TagKind::Other;
     }
-    auto key = tag_line.substr(0, space);
-    auto value_view = tag_line.substr(space + 1);
-    if (!value_view.empty() && value_view.front() == '"' && value_view.back() == '"') {
+}
+
+static_assert(classify_tag("White") == TagKind::White && classify_tag("Black") == TagKind::Black);
+static_assert(classify_tag("Result") == TagKind::Result && classify_tag("Termination") == TagKind::Termination);
+static_assert(classify_tag("UTCDate") == TagKind::UtcDate && classify_tag("UTCTime") == TagKind::UtcTime);
+static_assert(classify_tag("TimeControl") == TagKind::TimeControl);
+static_assert(classify_tag("WhiteElo") == TagKind::Other && classify_tag("Event") == TagKind::Other && classify_tag("white") == TagKind::Other);
+
+std::string_view tag_key(std::string_view tag_line) {
+    return tag_line.substr(0, tag_line.find(' '));
+}
+
+// Value of a tag line whose key is key_size bytes long, without its surrounding quotes.
+std::string_view tag_value(std::string_view tag_line, std::size_t key_size) {
+    if (key_size >= tag_line.size()) {
+        return {};
+    }
+    auto value_view = tag_line.substr(key_size + 1);
+    if (value_view.size() >= 2 && value_view.front() == '"' && value_view.back() == '"') {
         value_view = value_view.substr(1, value_view.size() - 2);
     }
-    return {std::string(key), std::string(value_view)};
+    return value_view;
 }
 
-std::vector<std::string> tokenize_moves(const std::string& text) {
-    constexpr std::size_t kMinMoveReserve = 4;  // Small PGNs still need a tiny buffer to avoid frequent growth.
-    constexpr std::size_t kMinTokenReserve = 4; // SAN tokens are short; keep a floor for tiny inputs.
-    std::vector<std::string> moves;
-    // Reserve roughly half the characters for move tokens, but keep a small floor to avoid zero-capacity reserve.
-    moves.reserve(std::max<std::size_t>(kMinMoveReserve, text.size() / 2));
-    std::string token;
-    // Tokens tend to be shorter than moves, so reserve ~1/4 of the text with a minimum to avoid immediate reallocs.
-    token.reserve(std::max<std::size_t>(kMinTokenReserve, text.size() / 4));
-    bool in_comment = false;
-    int variation_depth = 0;
-
-    auto flush_token = [&]() {
-        if (!token.empty()) {
-            moves.push_back(token);
-            token.clear();
+// The SAN of tokens that are actual moves: SAN (optionally prefixed by a move number such as "12."
+// or "2...", which is stripped), castling written with letters or zeros, and the "--" null move.
+// Empty for move numbers on their own, NAGs ("$1"), stand-alone annotation glyphs and result tokens,
+// which are not plies.
+std::string_view move_san(std::string_view token) {
+    std::size_t digits = 0;
+    while (digits < token.size() && token[digits] >= '0' && token[digits] <= '9') {
+        ++digits;
+    }
+    if (digits > 0 && digits < token.size() && token[digits] == '.') {
+        token.remove_prefix(digits);
+        while (!token.empty() && token.front() == '.') {
+            token.remove_prefix(1);
         }
-    };
+    }
+    if (token.empty()) {
+        return {};
+    }
+    switch (token.front()) {
+    case 'a': case 'b': case 'c': case 'd': case 'e': case 'f': case 'g': case 'h':
+    case 'K': case 'Q': case 'R': case 'B': case 'N': case 'P': case 'O':
+        return token;
+    case '0':
+        return token.starts_with("0-0") ? token : std::string_view{}; // "0-1" is a result, "0-0"/"0-0-0" is castling
+    case '-':
+        return token == "--" ? token : std::string_view{};
+    default:
+        return {};
+    }
+}
 
-    for (unsigned char ch : text) {
-        if (ch == '{') {
-            in_comment = true;
-            flush_token();
-            continue;
+// Walks movetext one line at a time, skipping {comments}, ;comments, %escape lines and
+// (variations, possibly nested). Plies are counted without allocating; SAN tokens are only
+// copied out when a move list is attached.
+class MovetextScanner {
+public:
+    void attach(PackedMoves* moves) { moves_ = moves; }
+
+    void feed(std::string_view line) {
+        if (!in_comment_ && !line.empty() && line.front() == '%') {
+            return;
         }
-        if (ch == '}') {
-            in_comment = false;
-            continue;
+        std::size_t token_start = std::string_view::npos;
+        auto flush = [&](std::size_t end) {
+            if (token_start != std::string_view::npos) {
+                on_token(line.substr(token_start, end - token_start));
+                token_start = std::string_view::npos;
+            }
+        };
+        for (std::size_t i = 0; i < line.size(); ++i) {
+            const char ch = line[i];
+            if (in_comment_) {
+                if (ch == '}') {
+                    in_comment_ = false;
+                }
+                continue;
+            }
+            switch (ch) {
+            case '{':
+                flush(i);
+                in_comment_ = true;
+                continue;
+            case ';':
+                flush(i);
+                return;
+            case '(':
+                flush(i);
+                ++variation_depth_;
+                continue;
+            case ')':
+                if (variation_depth_ > 0) {
+                    --variation_depth_;
+                }
+                continue;
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\v':
+            case '\f':
+                flush(i);
+                continue;
+            default:
+                if (variation_depth_ == 0 && token_start == std::string_view::npos) {
+                    token_start = i;
+                }
+            }
         }
-        if (ch == '(') {
-            ++variation_depth;
-            flush_token();
-            continue;
+        flush(line.size());
+    }
+
+    // Follows only the {comment} state through a line of a game that is being dropped, so a
+    // "[%clk ...]" line inside a wrapped comment is still not taken for a tag.
+    void skip(std::string_view line) {
+        if (!in_comment_ && !line.empty() && line.front() == '%') {
+            return;
         }
-        if (ch == ')') {
-            if (variation_depth > 0) {
-                --variation_depth;
+        std::size_t pos = 0;
+        while (pos < line.size()) {
+            if (in_comment_) {
+                pos = line.find('}', pos);
+                if (pos == std::string_view::npos) {
+                    return;
+                }
+                in_comment_ = false;
+            } else {
+                pos = line.find_first_of("{;", pos);
+                if (pos == std::string_view::npos || line[pos] == ';') {
+                    return;
+                }
+                in_comment_ = true;
             }
-            continue;
+            ++pos;
         }
-        if (in_comment || variation_depth > 0) {
-            continue;
+    }
+
+    std::uint32_t plies() const { return plies_; }
+    // A wrapped {comment} can put a line starting with '[' (e.g. "[%clk ...]") inside movetext.
+    bool in_comment() const { return in_comment_; }
+
+    void reset() {
+        plies_ = 0;
+        in_comment_ = false;
+        variation_depth_ = 0;
+    }
+
+private:
+    void on_token(std::string_view token) {
+        const auto san = move_san(token);
+        if (san.empty()) {
+            return;
         }
-        if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
-            flush_token();
-            continue;
+        ++plies_;
+        if (moves_ != nullptr) {
+            moves_->add(san);
         }
-        token.push_back(static_cast<char>(ch));
     }
-    flush_token();
-    return moves;
-}
 
-GameResult::Outcome outcome_from_result(const std::string& r) {
+    PackedMoves* moves_{nullptr};
+    std::uint32_t plies_{0};
+    bool in_comment_{false};
+    int variation_depth_{0};
+};
+
+GameResult::Outcome outcome_from_result(std::string_view r) {
     if (r == "1-0") {
         return GameResult::Outcome::WhiteWin;
     }
@@ -102,203 +225,335 @@ GameResult::Outcome outcome_from_result(const std::string& r) {
 
 } // namespace
 
-std::optional<std::vector<Game>> parse_pgn_chunk(const std::filesystem::path& file, std::size_t start, std::size_t end) {
-    std::vector<Game> games;
-    if (end <= start) {
-        return games;
-    }
+void PackedMoves::add(std::string_view token) {
+    text_.insert(text_.end(), token.begin(), token.end());
+    ends_.push_back(static_cast<std::uint32_t>(text_.size() - open_text_));
+}
 
-    std::ifstream in(file, std::ios::binary);
-    if (!in) {
-        return std::nullopt;
-    }
+void PackedMoves::end_game() {
+    games_.push_back(GameMoves{open_text_, open_first_, static_cast<std::uint32_t>(ends_.size() - open_first_)});
+    open_text_ = text_.size();
+    open_first_ = ends_.size();
+}
 
-    in.seekg(0, std::ios::end);
-    const auto total = static_cast<std::size_t>(in.tellg());
-    if (start >= total) {
-        return games;
-    }
-    end = std::min(end, total);
+MoveSpan PackedMoves::operator[](std::size_t game) const {
+    const auto& moves = games_[game];
+    const std::uint32_t* ends = ends_.data() + moves.first;
+    const std::size_t bytes = moves.count == 0 ? 0 : ends[moves.count - 1];
+    return MoveSpan(std::string_view(text_.data() + moves.text_begin, bytes), ends, moves.count);
+}
 
-    const std::size_t length = end - start;
-    std::string buffer(length, '\0');
-    in.seekg(static_cast<std::streamoff>(start), std::ios::beg);
-    in.read(buffer.data(), static_cast<std::streamoff>(length));
-    if (!in || static_cast<std::size_t>(in.gcount()) != length) {
-        return std::nullopt;
+void intern_tags(ParsedChunk& chunk, GameView& game) {
+    if (game.white_id == kNoTagId) {
+        game.white_id = chunk.players.intern(game.white);
+        game.black_id = chunk.players.intern(game.black);
     }
+    if (game.time_control) {
+        if (game.time_control_id == kNoTagId) {
+            game.time_control_id = chunk.time_controls.intern(*game.time_control);
+            if (game.time_control_id == chunk.time_control_specs.size()) {
+                chunk.time_control_specs.push_back(parse_time_control(*game.time_control));
+            }
+        }
+        const auto& spec = chunk.time_control_specs[game.time_control_id];
+        game.estimated_duration_seconds = spec ? std::optional<double>(spec->estimate_seconds(game.ply_count)) : std::nullopt;
+    }
+    if (game.termination && game.termination_id == kNoTagId) {
+        game.termination_id = chunk.terminations.intern(*game.termination);
+    }
+}
 
-    Game current;
+ParsedChunk parse_pgn_views(std::string_view buffer, const ParseOptions& options) {
+    ParsedChunk chunk;
+    GameView current;
     bool in_headers = true;
-    std::string move_text;
-
-    auto has_non_space = [](std::string_view text) -> bool {
-        return std::any_of(text.begin(), text.end(), [](unsigned char ch) {
-            return std::isspace(ch) == 0;
-        });
-    };
+    bool has_movetext = false;
+    MovetextScanner movetext;
+    movetext.attach(options.keep_moves ? &chunk.moves : nullptr);
+    std::optional<ChunkFilter> tag_filter;
+    if (options.filter != nullptr) {
+        tag_filter.emplace(chunk, *options.filter);
+    }
+    bool skipping = false; // the current game failed tag_filter
 
     auto flush_game = [&]() {
-        current.moves = tokenize_moves(move_text);
-        current.ply_count = static_cast<std::uint32_t>(current.moves.size());
-        if (current.meta.time_control) {
-            try {
-                current.estimated_duration_seconds = parse_duration_to_seconds(*current.meta.time_control);
-            } catch (const std::exception&) {
-                current.estimated_duration_seconds = std::nullopt;
+        if (!skipping) {
+            current.ply_count = movetext.plies();
+            intern_tags(chunk, current);
+            chunk.games.push_back(current);
+            if (options.keep_moves) {
+                chunk.moves.end_game();
             }
         }
-        games.push_back(std::move(current));
-        current = Game{};
-        move_text.clear();
+        skipping = false;
+        current = GameView{};
+        movetext.reset();
+        has_movetext = false;
         in_headers = true;
     };
 
-    std::size_t pos = 0;
-    while (pos < buffer.size()) {
-        std::size_t line_end = buffer.find('\n', pos);
-        if (line_end == std::string::npos) {
-            line_end = buffer.size();
-        }
-        std::string_view line_view(buffer.data() + pos, line_end - pos);
-        if (!line_view.empty() && line_view.back() == '\r') {
-            line_view.remove_suffix(1);
-        }
-
-        const bool is_blank = line_view.empty() || std::all_of(line_view.begin(), line_view.end(), [](unsigned char ch) {
-            return std::isspace(ch) != 0;
-        });
+    for_each_line(buffer, [&](std::string_view line_view, bool is_blank) {
         if (is_blank) {
-            if (!in_headers) {
-                if (has_non_space(move_text)) {
-                    flush_game();
-                }
+            if (!in_headers && has_movetext) {
+                flush_game();
+            }
+        } else if (line_view.front() == '[' && !movetext.in_comment()) {
+            if (!in_headers && has_movetext) {
+                flush_game(); // next game's tags without a separating blank line
             }
-        } else if (line_view.front() == '[') {
             auto tag_line = parse_tag_line(line_view);
             if (tag_line) {
-                const auto& [key, value] = split_tag(*tag_line);
-                if (key == "White") {
-                    current.meta.white = value;
-                } else if (key == "Black") {
-                    current.meta.black = value;
-                } else if (key == "Result") {
-                    current.result.outcome = outcome_from_result(value);
-                } else if (key == "Termination") {
-                    current.result.termination = value;
-                } else if (key == "UTCDate") {
-                    current.meta.utc_date = value;
-                } else if (key == "UTCTime") {
-                    current.meta.utc_time = value;
-                } else if (key == "TimeControl") {
-                    current.meta.time_control = value;
+                const auto key = tag_key(*tag_line);
+                const auto kind = classify_tag(key);
+                if (kind != TagKind::Other) {
+                    const auto value = tag_value(*tag_line, key.size());
+                    switch (kind) {
+                    case TagKind::White: current.white = value; break;
+                    case TagKind::Black: current.black = value; break;
+                    case TagKind::Result: current.outcome = outcome_from_result(value); break;
+                    case TagKind::Termination: current.termination = value; break;
+                    case TagKind::UtcDate: current.utc_date = value; break;
+                    case TagKind::UtcTime: current.utc_time = value; break;
+                    case TagKind::TimeControl: current.time_control = value; break;
+                    case TagKind::Other: break;
+                    }
                 }
             }
             in_headers = true;
         } else {
+            if (!has_movetext && tag_filter) {
+                intern_tags(chunk, current); // all of this game's tags are in
+                skipping = !tag_filter->passes_tags(current);
+            }
             in_headers = false;
-            move_text.append(line_view);
-            move_text.push_back(' ');
+            has_movetext = true;
+            if (skipping) {
+                movetext.skip(line_view);
+            } else {
+                movetext.feed(line_view);
+            }
         }
+    });
+    if (has_movetext) {
+        flush_game();
+    }
+    return chunk;
+}
+
+ParsedChunk parse_pgn_buffer(std::vector<char> buffer, const ParseOptions& options) {
+    // Moving the vector keeps its heap block, so the views stay valid inside the returned chunk.
+    auto chunk = parse_pgn_views(std::string_view(buffer.data(), buffer.size()), options);
+    chunk.storage = std::move(buffer);
+    return chunk;
+}
+
+std::optional<ParsedChunk> parse_pgn_chunk_views(const std::filesystem::path& file, std::size_t start, std::size_t end, const ParseOptions& options) {
+    if (end <= start) {
+        return ParsedChunk{};
+    }
+
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        return std::nullopt;
+    }
+
+    in.seekg(0, std::ios::end);
+    const auto total = static_cast<std::size_t>(in.tellg());
+    if (start >= total) {
+        return ParsedChunk{};
+    }
+    end = std::min(end, total);
 
-        if (line_end == buffer.size()) {
+    // Read one byte before start so the resync can tell whether start is itself at a line start.
+    const std::size_t read_from = start == 0 ? 0 : start - 1;
+    std::vector<char> buffer(end - read_from);
+    in.seekg(static_cast<std::streamoff>(read_from), std::ios::beg);
+    in.read(buffer.data(), static_cast<std::streamoff>(buffer.size()));
+    if (!in || static_cast<std::size_t>(in.gcount()) != buffer.size()) {
+        return std::nullopt;
+    }
+    const std::size_t end_in_buffer = buffer.size();
+
+    // Keep reading past end until the next game starts (or EOF) so the last game is complete.
+    constexpr std::size_t kExtensionBytes = 64u * 1024u;
+    constexpr std::size_t kBoundaryOverlap = 8; // "\n[Event" may straddle two reads
+    std::size_t search_from = end_in_buffer;
+    std::size_t stop = std::string_view::npos;
+    while (true) {
+        stop = find_game_start(std::string_view(buffer.data(), buffer.size()), search_from);
+        if (stop != std::string_view::npos || read_from + buffer.size() >= total) {
             break;
         }
-        pos = line_end + 1;
+        const std::size_t filled = buffer.size();
+        const std::size_t extra = std::min(kExtensionBytes, total - (read_from + filled));
+        buffer.resize(filled + extra);
+        in.read(buffer.data() + filled, static_cast<std::streamoff>(extra));
+        if (!in || static_cast<std::size_t>(in.gcount()) != extra) {
+            return std::nullopt;
+        }
+        search_from = std::max(end_in_buffer, filled > kBoundaryOverlap ? filled - kBoundaryOverlap : 0);
     }
-    if (has_non_space(move_text)) {
-        flush_game();
+    if (stop == std::string_view::npos) {
+        stop = buffer.size();
     }
-    return games;
+
+    const std::string_view text(buffer.data(), buffer.size());
+    const std::size_t begin = start == 0 ? 0 : find_game_start(text, 1);
+    if (begin == std::string_view::npos || begin >= end_in_buffer) {
+        return ParsedChunk{}; // no game starts inside [start, end)
+    }
+    buffer.resize(stop);
+    buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(begin));
+    return parse_pgn_buffer(std::move(buffer), options);
 }
 
-static bool contains_case_insensitive(std::string_view haystack, std::string_view needle) {
-    if (needle.empty()) {
-        return true;
+std::optional<ParsedChunk> parse_pgn_chunk_views(std::shared_ptr<const MappedFile> file, std::size_t start, std::size_t end, const ParseOptions& options) {
+    if (!file) {
+        return std::nullopt;
     }
-    auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(), [](char a, char b) {
-        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
-    });
-    return it != haystack.end();
+    const auto [begin, stop] = resolve_chunk_span(file->view(), start, end);
+    if (begin >= stop) {
+        return ParsedChunk{};
+    }
+    file->advise_sequential(begin, stop);
+    auto chunk = parse_pgn_views(file->view().substr(begin, stop - begin), options);
+    chunk.mapped = MappedRange(std::move(file), begin, stop);
+    return chunk;
 }
 
-bool passes_filters(const Game& game, const FilterConfig& config) {
-    if (config.require_complete) {
-        if (game.meta.white.empty() || game.meta.black.empty()) {
-            return false;
-        }
-        if (game.result.outcome == GameResult::Outcome::Unknown) {
-            return false;
+GameView view_of(const Game& game) {
+    GameView view;
+    view.white = game.meta.white;
+    view.black = game.meta.black;
+    view.utc_date = game.meta.utc_date;
+    view.utc_time = game.meta.utc_time;
+    view.time_control = game.meta.time_control;
+    view.termination = game.result.termination;
+    view.outcome = game.result.outcome;
+    view.ply_count = game.ply_count;
+    view.estimated_duration_seconds = game.estimated_duration_seconds;
+    return view;
+}
+
+Game to_game(const ParsedChunk& chunk, std::size_t index) {
+    const auto& view = chunk.games[index];
+    auto to_string = [](const std::optional<std::string_view>& value) -> std::optional<std::string> {
+        if (!value) {
+            return std::nullopt;
         }
+        return std::string(*value);
+    };
+    Game game;
+    game.meta.white = std::string(view.white);
+    game.meta.black = std::string(view.black);
+    game.meta.utc_date = to_string(view.utc_date);
+    game.meta.utc_time = to_string(view.utc_time);
+    game.meta.time_control = to_string(view.time_control);
+    game.result.outcome = view.outcome;
+    game.result.termination = to_string(view.termination);
+    if (index < chunk.moves.games()) {
+        game.moves = MoveList(chunk.moves[index]);
     }
-    if (config.skip_empty && game.result.outcome == GameResult::Outcome::Unknown) {
-        return false;
+    game.ply_count = view.ply_count;
+    game.estimated_duration_seconds = view.estimated_duration_seconds;
+    return game;
+}
+
+std::vector<Game> parse_pgn_text(std::string_view text, const ParseOptions& options) {
+    auto chunk = parse_pgn_views(text, options);
+    std::vector<Game> games;
+    games.reserve(chunk.games.size());
+    for (std::size_t i = 0; i < chunk.games.size(); ++i) {
+        games.push_back(to_game(chunk, i));
     }
+    return games;
+}
 
-    if (config.min_plies && game.ply_count < *config.min_plies) {
-        return false;
+std::optional<std::vector<Game>> parse_pgn_chunk(const std::filesystem::path& file, std::size_t start, std::size_t end, const ParseOptions& options) {
+    auto chunk = parse_pgn_chunk_views(file, start, end, options);
+    if (!chunk) {
+        return std::nullopt;
     }
-    if (config.max_plies && game.ply_count > *config.max_plies) {
-        return false;
+    std::vector<Game> games;
+    games.reserve(chunk->games.size());
+    for (std::size_t i = 0; i < chunk->games.size(); ++i) {
+        games.push_back(to_game(*chunk, i));
     }
+    return games;
+}
 
-    if (config.min_time_seconds || config.max_time_seconds) {
-        // Defensive: some Game instances may be constructed outside parse_pgn_chunk (tests/other paths),
-        // so estimated_duration_seconds may be unset even when TimeControl exists.
-        std::optional<double> duration = game.estimated_duration_seconds;
-        if (!duration && game.meta.time_control) {
-            try {
-                duration = parse_duration_to_seconds(*game.meta.time_control);
-            } catch (const std::exception&) {
-                duration = std::nullopt;
-            }
-        }
-        if (!duration) {
-            return false;
-        }
-        if (config.min_time_seconds && *duration < *config.min_time_seconds) {
-            return false;
-        }
-        if (config.max_time_seconds && *duration > *config.max_time_seconds) {
-            return false;
-        }
+std::optional<std::vector<Game>> parse_pgn_chunk(const MappedFile& file, std::size_t start, std::size_t end, const ParseOptions& options) {
+    const auto [begin, stop] = resolve_chunk_span(file.view(), start, end);
+    if (begin >= stop) {
+        return std::vector<Game>{};
     }
+    file.advise_sequential(begin, stop);
+    auto games = parse_pgn_text(file.view().substr(begin, stop - begin), options);
+    file.release(begin, stop);
+    return games;
+}
 
-    if (config.white_name && !contains_case_insensitive(game.meta.white, *config.white_name)) {
-        return false;
+bool passes_filters(const GameView& game, const FilterProgram& program) {
+    return program.passes(game);
+}
+
+bool passes_filters(const Game& game, const FilterProgram& program) {
+    return program.passes(view_of(game));
+}
+
+ChunkFilter::ChunkFilter(const ParsedChunk& chunk, const FilterProgram& program) : chunk_(chunk), program_(program) {
+    sync();
+}
+
+void ChunkFilter::sync() {
+    while (name_matches_.size() < chunk_.players.size()) {
+        const auto id = static_cast<std::uint32_t>(name_matches_.size());
+        name_matches_.push_back(program_.name_matches(chunk_.players[id]));
     }
-    if (config.black_name && !contains_case_insensitive(game.meta.black, *config.black_name)) {
-        return false;
+    while (time_verdicts_.size() < chunk_.time_control_specs.size()) {
+        time_verdicts_.push_back(program_.time_verdict(chunk_.time_control_specs[time_verdicts_.size()]));
     }
-    if (config.either_name && !(contains_case_insensitive(game.meta.white, *config.either_name) || contains_case_insensitive(game.meta.black, *config.either_name))) {
-        return false;
+    while (termination_passes_.size() < chunk_.terminations.size()) {
+        const auto id = static_cast<std::uint32_t>(termination_passes_.size());
+        termination_passes_.push_back(program_.passes_termination(chunk_.terminations[id]));
     }
-    if (config.exclude_name && (contains_case_insensitive(game.meta.white, *config.exclude_name) || contains_case_insensitive(game.meta.black, *config.exclude_name))) {
-        return false;
+}
+
+FilterProgram::Verdict ChunkFilter::time_verdict(const GameView& game) const {
+    if (game.time_control_id != kNoTagId) {
+        return time_verdicts_[game.time_control_id];
+    }
+    if (!game.time_control) {
+        return program_.passes_time(std::nullopt) ? FilterProgram::Verdict::Accept : FilterProgram::Verdict::Reject;
     }
+    return FilterProgram::Verdict::PerGame;
+}
 
-    if (config.result_filter) {
-        const auto& rf = *config.result_filter;
-        if (rf == "1-0" && game.result.outcome != GameResult::Outcome::WhiteWin) {
-            return false;
-        }
-        if (rf == "0-1" && game.result.outcome != GameResult::Outcome::BlackWin) {
-            return false;
-        }
-        if ((rf == "draw" || rf == "1/2-1/2") && game.result.outcome != GameResult::Outcome::Draw) {
-            return false;
-        }
+bool ChunkFilter::names_pass(const GameView& game) const {
+    if (game.white_id == kNoTagId) {
+        return program_.passes_names(program_.name_matches(game.white), program_.name_matches(game.black));
     }
+    return program_.passes_names(name_matches_[game.white_id], name_matches_[game.black_id]);
+}
 
-    if (config.termination) {
-        if (!game.result.termination) {
-            return false;
-        }
-        if (!contains_case_insensitive(*game.result.termination, *config.termination)) {
-            return false;
-        }
+bool ChunkFilter::termination_passes(const GameView& game) const {
+    return game.termination_id != kNoTagId ? termination_passes_[game.termination_id] : program_.passes_termination(game.termination);
+}
+
+bool ChunkFilter::passes_tags(const GameView& game) {
+    sync();
+    return program_.passes_outcome(game) && names_pass(game) && time_verdict(game) != FilterProgram::Verdict::Reject &&
+           termination_passes(game);
+}
+
+bool ChunkFilter::passes(std::size_t index) {
+    sync();
+    const auto& game = chunk_.games[index];
+    if (!program_.passes_outcome(game) || !names_pass(game) || !program_.passes_plies(game.ply_count) || !termination_passes(game)) {
+        return false;
     }
-    return true;
+    const auto verdict = time_verdict(game);
+    return verdict == FilterProgram::Verdict::PerGame ? program_.passes_time(estimated_duration(game)) : verdict == FilterProgram::Verdict::Accept;
 }
 
 } // namespace bayeselo
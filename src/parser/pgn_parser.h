@@ -1,16 +1,127 @@
 #pragma once
 
+#include "bayeselo/duration.h"
 #include "bayeselo/filters.h"
 #include "bayeselo/game.h"
+#include "parser/filter_program.h"
+#include "parser/tag_dictionary.h"
+#include "util/mapped_file.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace bayeselo {
 
-std::optional<std::vector<Game>> parse_pgn_chunk(const std::filesystem::path& file, std::size_t start, std::size_t end);
-bool passes_filters(const Game& game, const FilterConfig& config);
+// How chunk bytes are brought into memory. Mmap maps each file once and parses straight out of
+// the mapping; Stream opens the file per chunk and copies the range into a buffer (fallback for
+// non-mappable inputs and platforms without mmap).
+enum class IoBackend {
+    Mmap,
+    Stream
+};
+
+struct ParseOptions {
+    // When false, movetext is only walked to count plies and Game::moves stays empty, so no
+    // per-move strings are ever allocated.
+    bool keep_moves{true};
+    // When set, a game this rejects from its tags alone is dropped at the end of its tags and its
+    // movetext is skipped unscanned. Leave unset when every game is needed (e.g. for a cache).
+    const FilterProgram* filter{nullptr};
+};
+
+// SAN moves of every game in a chunk, packed into one buffer (see MoveList); per-game offsets are
+// relative to the game's first token, so spans stay valid when the chunk is moved.
+class PackedMoves {
+public:
+    void add(std::string_view token);
+    // Closes the current game; call once per parsed game, in order.
+    void end_game();
+
+    std::size_t games() const { return games_.size(); }
+    MoveSpan operator[](std::size_t game) const;
+
+private:
+    struct GameMoves {
+        std::size_t text_begin{0};
+        std::size_t first{0}; // index into ends_
+        std::uint32_t count{0};
+    };
+    std::vector<char> text_;
+    std::vector<std::uint32_t> ends_;
+    std::vector<GameMoves> games_;
+    std::size_t open_text_{0};
+    std::size_t open_first_{0};
+};
+
+// Games parsed from one chunk. The views point into storage (stream backend) or into the mapped
+// range (mmap backend); both live as long as the chunk, so all tag strings are freed at once.
+struct ParsedChunk {
+    std::vector<GameView> games;
+    PackedMoves moves; // parallel to games; only filled with keep_moves
+    TagDictionary players; // White and Black names
+    TagDictionary time_controls;
+    std::vector<TimeControlResult> time_control_specs; // parallel to time_controls
+    TagDictionary terminations;
+    std::vector<char> storage;
+    MappedRange mapped;
+};
+
+// Sets game's tag ids from its tag views, interning new values into the chunk's dictionaries, and
+// estimates its duration from its ply count and the TimeControl (parsed once per distinct value).
+// Chunk parsers call this for every game once ply_count is known; calling it again only updates
+// the estimate.
+void intern_tags(ParsedChunk& chunk, GameView& game);
+
+// Parses complete games from an in-memory PGN slice; the views in the result point into text.
+ParsedChunk parse_pgn_views(std::string_view text, const ParseOptions& options = {});
+// Parses a buffer the chunk takes ownership of (e.g. a block read from a stream).
+ParsedChunk parse_pgn_buffer(std::vector<char> buffer, const ParseOptions& options = {});
+// Chunk parsers take raw byte ranges (see split_pgn_file): they skip to the first game starting in
+// [start, end) and read past end to complete the last one.
+std::optional<ParsedChunk> parse_pgn_chunk_views(const std::filesystem::path& file, std::size_t start, std::size_t end, const ParseOptions& options = {});
+std::optional<ParsedChunk> parse_pgn_chunk_views(std::shared_ptr<const MappedFile> file, std::size_t start, std::size_t end, const ParseOptions& options = {});
+
+GameView view_of(const Game& game);
+Game to_game(const ParsedChunk& chunk, std::size_t index);
+
+// Owning-Game convenience wrappers over the view parser.
+std::vector<Game> parse_pgn_text(std::string_view text, const ParseOptions& options = {});
+std::optional<std::vector<Game>> parse_pgn_chunk(const std::filesystem::path& file, std::size_t start, std::size_t end, const ParseOptions& options = {});
+std::optional<std::vector<Game>> parse_pgn_chunk(const MappedFile& file, std::size_t start, std::size_t end, const ParseOptions& options = {});
+// Whole-filter checks for single games; compile the FilterProgram once and reuse it across games.
+bool passes_filters(const GameView& game, const FilterProgram& program);
+bool passes_filters(const Game& game, const FilterProgram& program);
+
+// Applies a FilterProgram to the games of one chunk. Name matches and the time and termination
+// verdicts are worked out once per distinct player or tag value, leaving table lookups per game. The tables grow as
+// the chunk's dictionaries do, so a parser can use it while the chunk is being filled.
+class ChunkFilter {
+public:
+    ChunkFilter(const ParsedChunk& chunk, const FilterProgram& program);
+
+    // Checks that need only the game's tags (with its tag ids interned into the chunk); false means
+    // the game can be dropped without scanning its movetext.
+    bool passes_tags(const GameView& game);
+    // Every check, for a game of the chunk.
+    bool passes(std::size_t index);
+
+private:
+    void sync();
+    bool names_pass(const GameView& game) const;
+    FilterProgram::Verdict time_verdict(const GameView& game) const;
+    bool termination_passes(const GameView& game) const;
+
+    const ParsedChunk& chunk_;
+    const FilterProgram& program_;
+    std::vector<std::uint8_t> name_matches_; // per players id, see FilterProgram::name_matches
+    std::vector<FilterProgram::Verdict> time_verdicts_; // per time_controls id
+    std::vector<bool> termination_passes_; // per terminations id
+};
 
 } // namespace bayeselo
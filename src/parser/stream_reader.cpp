@@ -0,0 +1,54 @@
+#include "stream_reader.h"
+
+#include "chunk_splitter.h"
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+namespace bayeselo {
+
+PgnStreamReader::PgnStreamReader(std::istream& in, std::size_t chunk_bytes)
+    : in_(in), chunk_bytes_(std::max<std::size_t>(chunk_bytes, 1)) {}
+
+std::optional<std::vector<char>> PgnStreamReader::next() {
+    std::vector<char> block;
+    if (!next(block)) {
+        return std::nullopt;
+    }
+    return block;
+}
+
+bool PgnStreamReader::next(std::vector<char>& block) {
+    block.assign(carry_.begin(), carry_.end());
+    carry_.clear();
+    while (true) {
+        if (!eof_) {
+            const std::size_t filled = block.size();
+            const std::size_t target = std::max(filled + chunk_bytes_ / 2, chunk_bytes_);
+            block.resize(target);
+            in_.read(block.data() + filled, static_cast<std::streamsize>(target - filled));
+            const auto got = static_cast<std::size_t>(in_.gcount());
+            block.resize(filled + got);
+            if (in_.bad()) {
+                failed_ = true;
+                eof_ = true;
+            } else if (!in_) {
+                eof_ = true; // short read: end of stream
+            }
+        }
+        if (eof_) {
+            return !block.empty();
+        }
+        const std::string_view text(block.data(), block.size());
+        const std::size_t cut = find_last_game_start(text);
+        // A cut at offset 0 would leave the block empty: the carried-over game is still incomplete.
+        if (cut != std::string_view::npos && cut > 0) {
+            carry_.assign(block.begin() + static_cast<std::ptrdiff_t>(cut), block.end());
+            block.resize(cut);
+            return true;
+        }
+    }
+}
+
+} // namespace bayeselo
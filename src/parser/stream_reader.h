@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <vector>
+
+namespace bayeselo {
+
+// Reads a PGN stream that cannot be seeked (stdin, pipes, FIFOs) into blocks of roughly
+// chunk_bytes. Each block is cut just before the last game start it contains and the remainder
+// is carried into the next block, so every block holds only whole games and can be parsed
+// independently while the next one is being read.
+class PgnStreamReader {
+public:
+    PgnStreamReader(std::istream& in, std::size_t chunk_bytes);
+
+    // Next block of whole games, or nullopt once the stream is exhausted. A single game larger than
+    // chunk_bytes grows the block until the game is complete.
+    std::optional<std::vector<char>> next();
+    // Same, reading into block (e.g. a recycled buffer, whose capacity is reused); false once the
+    // stream is exhausted.
+    bool next(std::vector<char>& block);
+
+    bool failed() const { return failed_; }
+
+private:
+    std::istream& in_;
+    std::size_t chunk_bytes_;
+    std::vector<char> carry_;
+    bool eof_{false};
+    bool failed_{false};
+};
+
+} // namespace bayeselo
@@ -0,0 +1,30 @@
+#include "tag_dictionary.h"
+
+namespace bayeselo {
+
+std::uint32_t TagDictionary::intern(std::string_view value) {
+    if (last_ < values_.size() && values_[last_] == value) {
+        return last_;
+    }
+    if (index_.empty()) {
+        for (std::uint32_t id = 0; id < values_.size(); ++id) {
+            if (values_[id] == value) {
+                return last_ = id;
+            }
+        }
+    } else if (const auto it = index_.find(value); it != index_.end()) {
+        return last_ = it->second;
+    }
+    last_ = static_cast<std::uint32_t>(values_.size());
+    values_.push_back(value);
+    if (!index_.empty()) {
+        index_.emplace(value, last_);
+    } else if (values_.size() > kLinearScanLimit) {
+        for (std::uint32_t id = 0; id < values_.size(); ++id) {
+            index_.emplace(values_[id], id);
+        }
+    }
+    return last_;
+}
+
+} // namespace bayeselo
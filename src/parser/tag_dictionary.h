@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace bayeselo {
+
+// Distinct values of a low-cardinality tag (TimeControl, Termination) within one chunk. Games refer
+// to values by id, so anything derived from a value is computed once per value, not once per game.
+// The values are views into the chunk's bytes.
+class TagDictionary {
+public:
+    std::uint32_t intern(std::string_view value);
+
+    std::size_t size() const { return values_.size(); }
+    std::string_view operator[](std::uint32_t id) const { return values_[id]; }
+
+private:
+    // A fastchess run has one or two values; a linear scan beats hashing until there are many.
+    static constexpr std::size_t kLinearScanLimit = 16;
+
+    std::vector<std::string_view> values_;
+    std::unordered_map<std::string_view, std::uint32_t> index_; // built once values_ outgrows the scan
+    std::uint32_t last_{0};
+};
+
+} // namespace bayeselo
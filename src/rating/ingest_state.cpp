@@ -0,0 +1,186 @@
+#include "ingest_state.h"
+
+#include "parser/chunk_splitter.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <initializer_list>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+namespace bayeselo {
+
+namespace {
+
+constexpr std::array<char, 8> kMagic = {'B', 'E', 'I', 'N', 'G', 'E', 'S', 'T'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeadHashBytes = 64 * 1024;
+
+std::uint64_t fnv1a(std::string_view text, std::uint64_t hash = 0xcbf29ce484222325ull) {
+    for (const char ch : text) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template <typename T>
+void put(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void put_string(std::ostream& out, std::string_view text) {
+    put(out, static_cast<std::uint32_t>(text.size()));
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+template <typename T>
+bool get(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool get_string(std::istream& in, std::string& text) {
+    std::uint32_t size = 0;
+    if (!get(in, size) || size > (1u << 20)) {
+        return false;
+    }
+    text.resize(size);
+    return static_cast<bool>(in.read(text.data(), size));
+}
+
+} // namespace
+
+std::optional<IngestState> load_ingest_state(const std::filesystem::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    std::array<char, 8> magic{};
+    std::uint32_t version = 0;
+    IngestState state;
+    std::uint64_t players = 0;
+    std::uint64_t files = 0;
+    if (!get(in, magic) || magic != kMagic || !get(in, version) || version != kVersion || !get(in, state.filter_fingerprint) ||
+        !get(in, players) || !get(in, files)) {
+        return std::nullopt;
+    }
+    for (std::uint64_t i = 0; i < players; ++i) {
+        if (!get_string(in, state.players.emplace_back())) {
+            return std::nullopt;
+        }
+    }
+    for (std::uint64_t f = 0; f < files; ++f) {
+        auto& entry = state.files.emplace_back();
+        std::uint64_t pairings = 0;
+        if (!get_string(in, entry.path) || !get(in, entry.offset) || !get(in, entry.head_hash) || !get(in, pairings)) {
+            return std::nullopt;
+        }
+        for (std::uint64_t p = 0; p < pairings; ++p) {
+            std::uint32_t white = 0;
+            std::uint32_t black = 0;
+            std::uint8_t half_points = 0; // score * 2
+            if (!get(in, white) || !get(in, black) || !get(in, half_points) || white >= players || black >= players || half_points > 2) {
+                return std::nullopt;
+            }
+            entry.pairings.push_back(Pairing{white, black, half_points / 2.0});
+        }
+    }
+    if (in.peek() != std::ifstream::traits_type::eof()) {
+        return std::nullopt;
+    }
+    return state;
+}
+
+bool save_ingest_state(const std::filesystem::path& file, const IngestState& state) {
+    auto temp = file;
+    temp += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        put(out, kMagic);
+        put(out, kVersion);
+        put(out, state.filter_fingerprint);
+        put(out, static_cast<std::uint64_t>(state.players.size()));
+        put(out, static_cast<std::uint64_t>(state.files.size()));
+        for (const auto& name : state.players) {
+            put_string(out, name);
+        }
+        for (const auto& entry : state.files) {
+            put_string(out, entry.path);
+            put(out, entry.offset);
+            put(out, entry.head_hash);
+            put(out, static_cast<std::uint64_t>(entry.pairings.size()));
+            for (const auto& pairing : entry.pairings) {
+                put(out, static_cast<std::uint32_t>(pairing.white));
+                put(out, static_cast<std::uint32_t>(pairing.black));
+                put(out, static_cast<std::uint8_t>(pairing.score * 2.0 + 0.5));
+            }
+        }
+        if (!out.flush()) {
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, file, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t filter_fingerprint(const FilterConfig& filters) {
+    std::ostringstream text;
+    auto field = [&](const auto& value) {
+        if (value) {
+            text << '+' << *value;
+        }
+        text << '\x1f';
+    };
+    field(filters.min_plies);
+    field(filters.max_plies);
+    field(filters.min_time_seconds);
+    field(filters.max_time_seconds);
+    field(filters.white_name);
+    field(filters.black_name);
+    field(filters.either_name);
+    field(filters.exclude_name);
+    for (const auto* list : {&filters.include_names, &filters.exclude_names}) {
+        for (const auto& pattern : *list) {
+            text << '\x1e' << pattern;
+        }
+        text << '\x1f';
+    }
+    field(filters.result_filter);
+    field(filters.termination);
+    text << filters.require_complete << filters.skip_empty;
+    return fnv1a(text.str());
+}
+
+std::uint64_t file_head_hash(std::string_view data, std::size_t offset) {
+    return fnv1a(data.substr(0, std::min({offset, data.size(), kHeadHashBytes})));
+}
+
+std::size_t complete_games_end(std::string_view text) {
+    const std::size_t last = find_last_game_start(text);
+    const std::size_t begin = last == std::string_view::npos ? 0 : last;
+    // A finished game ends with its result token (after the tags, which end in ']') and a newline.
+    std::string_view game = text.substr(begin);
+    const std::size_t content_end = game.find_last_not_of(" \t\r\n");
+    if (content_end == std::string_view::npos || content_end + 1 == game.size()) {
+        return content_end == std::string_view::npos ? text.size() : begin;
+    }
+    game = game.substr(0, content_end + 1);
+    for (std::string_view result : {"1-0", "0-1", "1/2-1/2", "*"}) {
+        if (game.ends_with(result)) {
+            const std::size_t before = game.size() - result.size();
+            if (before == 0 || std::isspace(static_cast<unsigned char>(game[before - 1])) || game[before - 1] == '}' || game[before - 1] == ')') {
+                return text.size();
+            }
+        }
+    }
+    return begin;
+}
+
+} // namespace bayeselo
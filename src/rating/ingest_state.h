@@ -0,0 +1,46 @@
+#pragma once
+
+#include "bayeselo/filters.h"
+#include "rating/bayeselo_solver.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bayeselo {
+
+// Progress of one growing PGN file: everything before offset has been parsed, and the accepted
+// games from that prefix are in pairings (player indices refer to IngestState::players).
+struct IngestedFile {
+    std::string path; // absolute
+    std::uint64_t offset{0};
+    std::uint64_t head_hash{0}; // of the file's first bytes, to notice a replaced or rewritten file
+    std::vector<Pairing> pairings;
+};
+
+// Persisted between runs by --state so a re-run only parses what was appended since.
+struct IngestState {
+    std::uint64_t filter_fingerprint{0};
+    std::vector<std::string> players;
+    std::vector<IngestedFile> files;
+};
+
+std::optional<IngestState> load_ingest_state(const std::filesystem::path& file);
+// Writes through a temporary file and a rename, so an interrupted run leaves the old state intact.
+bool save_ingest_state(const std::filesystem::path& file, const IngestState& state);
+
+// Pairings only stay valid under the filters they were accepted with.
+std::uint64_t filter_fingerprint(const FilterConfig& filters);
+
+// Hash of the first bytes of data[0, offset), compared on reload to check the prefix is unchanged.
+std::uint64_t file_head_hash(std::string_view data, std::size_t offset);
+
+// End of the last complete game in text: the start of a trailing game that is still being written,
+// or text.size() when the last game ends with its result and a newline.
+std::size_t complete_games_end(std::string_view text);
+
+} // namespace bayeselo
@@ -0,0 +1,90 @@
+#include "aho_corasick.h"
+
+#include <deque>
+
+namespace bayeselo {
+
+namespace {
+
+constexpr unsigned char fold(unsigned char ch) {
+    return ch >= 'A' && ch <= 'Z' ? static_cast<unsigned char>(ch | 0x20) : ch;
+}
+
+} // namespace
+
+AhoCorasick::AhoCorasick(const std::vector<std::string>& patterns) {
+    for (const auto& pattern : patterns) {
+        for (const char ch : pattern) {
+            const auto folded = fold(static_cast<unsigned char>(ch));
+            if (byte_class_[folded] == 0) {
+                byte_class_[folded] = static_cast<std::uint8_t>(classes_++);
+            }
+        }
+    }
+    for (unsigned ch = 'A'; ch <= 'Z'; ++ch) {
+        byte_class_[ch] = byte_class_[fold(static_cast<unsigned char>(ch))];
+    }
+
+    // Trie first; 0 in next_ means "no edge yet" (the root is never a child).
+    constexpr std::uint32_t kRoot = 0;
+    states_ = 1;
+    next_.assign(classes_, 0);
+    accepting_.assign(1, false);
+    for (const auto& pattern : patterns) {
+        std::uint32_t state = kRoot;
+        for (const char ch : pattern) {
+            const std::size_t cls = byte_class_[static_cast<unsigned char>(ch)];
+            auto& edge = next_[state * classes_ + cls];
+            if (edge == 0) {
+                edge = static_cast<std::uint32_t>(states_++);
+                next_.resize(states_ * classes_, 0);
+                accepting_.push_back(false);
+            }
+            state = next_[state * classes_ + cls];
+        }
+        accepting_[state] = true; // the empty pattern makes the root accepting: everything matches
+    }
+
+    // Breadth-first: point missing edges at the failure state's transition, completing the DFA.
+    std::vector<std::uint32_t> failure(states_, kRoot);
+    std::deque<std::uint32_t> queue;
+    for (std::size_t cls = 0; cls < classes_; ++cls) {
+        if (const auto child = next_[cls]; child != 0) {
+            queue.push_back(child);
+        }
+    }
+    while (!queue.empty()) {
+        const auto state = queue.front();
+        queue.pop_front();
+        accepting_[state] = accepting_[state] || accepting_[failure[state]];
+        for (std::size_t cls = 0; cls < classes_; ++cls) {
+            auto& edge = next_[state * classes_ + cls];
+            const auto fallback = next_[failure[state] * classes_ + cls];
+            if (edge != 0) {
+                failure[edge] = fallback;
+                queue.push_back(edge);
+            } else {
+                edge = fallback;
+            }
+        }
+    }
+}
+
+bool AhoCorasick::contains_any(std::string_view text) const {
+    if (states_ == 0) {
+        return false;
+    }
+    if (accepting_[0]) {
+        return true;
+    }
+    std::uint32_t state = 0;
+    for (const char ch : text) {
+        state = next_[state * classes_ + byte_class_[static_cast<unsigned char>(ch)]];
+        if (accepting_[state]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace bayeselo
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bayeselo {
+
+// Aho-Corasick automaton answering "does this text contain any of the patterns", ignoring ASCII
+// case, in one pass over the text whatever the number of patterns. Built as a full DFA over the
+// byte classes that occur in the patterns, so each text byte costs one table lookup.
+class AhoCorasick {
+public:
+    AhoCorasick() = default;
+    explicit AhoCorasick(const std::vector<std::string>& patterns);
+
+    bool contains_any(std::string_view text) const;
+
+private:
+    std::array<std::uint8_t, 256> byte_class_{}; // 0: bytes no pattern contains
+    std::size_t classes_{1};
+    std::size_t states_{0};
+    std::vector<std::uint32_t> next_; // states_ x classes_
+    std::vector<bool> accepting_; // a pattern ends here or at a suffix of this state
+};
+
+} // namespace bayeselo
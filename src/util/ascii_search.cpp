@@ -0,0 +1,117 @@
+#include "ascii_search.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BAYESELO_ASCII_SEARCH_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define BAYESELO_ASCII_SEARCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace bayeselo {
+
+namespace {
+
+constexpr char fold(char ch) {
+    return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch | 0x20) : ch;
+}
+
+bool equals_folded(const char* text, std::string_view lowered) {
+    for (std::size_t i = 0; i < lowered.size(); ++i) {
+        if (fold(text[i]) != lowered[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool contains_scalar(std::string_view haystack, std::string_view needle, std::size_t from) {
+    for (std::size_t pos = from; pos + needle.size() <= haystack.size(); ++pos) {
+        if (fold(haystack[pos]) == needle.front() && equals_folded(haystack.data() + pos + 1, needle.substr(1))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef BAYESELO_ASCII_SEARCH_SSE2
+__m128i fold16(__m128i bytes) {
+    // Bytes >= 0x80 are negative as signed chars, so they never fall in 'A'..'Z'.
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+#ifdef BAYESELO_ASCII_SEARCH_NEON
+uint8x16_t fold16(uint8x16_t bytes) {
+    const uint8x16_t upper = vcleq_u8(vsubq_u8(bytes, vdupq_n_u8('A')), vdupq_n_u8('Z' - 'A'));
+    return vorrq_u8(bytes, vandq_u8(upper, vdupq_n_u8(0x20)));
+}
+#endif
+
+} // namespace
+
+// Blocks of 16 candidate positions are screened by comparing the needle's first and last byte
+// against the folded haystack at both ends at once; only positions matching both are verified.
+bool contains_ascii_nocase(std::string_view haystack, std::string_view needle) {
+    const std::size_t n = needle.size();
+    if (n == 0) {
+        return true;
+    }
+    if (n > haystack.size()) {
+        return false;
+    }
+    std::size_t pos = 0;
+    [[maybe_unused]] const std::string_view middle = n > 2 ? needle.substr(1, n - 2) : std::string_view{};
+    [[maybe_unused]] const char* data = haystack.data();
+#if defined(BAYESELO_ASCII_SEARCH_SSE2)
+    const __m128i first = _mm_set1_epi8(needle.front());
+    const __m128i last = _mm_set1_epi8(needle.back());
+    for (; pos + n - 1 + 16 <= haystack.size(); pos += 16) {
+        const __m128i starts = fold16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)));
+        const __m128i ends = fold16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + n - 1)));
+        auto candidates = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(starts, first), _mm_cmpeq_epi8(ends, last))));
+        while (candidates != 0) {
+            const auto bit = static_cast<std::size_t>(std::countr_zero(candidates));
+            if (equals_folded(data + pos + bit + 1, middle)) {
+                return true;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+#elif defined(BAYESELO_ASCII_SEARCH_NEON)
+    const uint8x16_t first = vdupq_n_u8(static_cast<std::uint8_t>(needle.front()));
+    const uint8x16_t last = vdupq_n_u8(static_cast<std::uint8_t>(needle.back()));
+    for (; pos + n - 1 + 16 <= haystack.size(); pos += 16) {
+        const uint8x16_t starts = fold16(vld1q_u8(reinterpret_cast<const std::uint8_t*>(data + pos)));
+        const uint8x16_t ends = fold16(vld1q_u8(reinterpret_cast<const std::uint8_t*>(data + pos + n - 1)));
+        const uint8x16_t hits = vandq_u8(vceqq_u8(starts, first), vceqq_u8(ends, last));
+        if (vmaxvq_u8(hits) == 0) {
+            continue;
+        }
+        for (std::size_t bit = 0; bit < 16; ++bit) {
+            if (fold(data[pos + bit]) == needle.front() && fold(data[pos + bit + n - 1]) == needle.back() &&
+                equals_folded(data + pos + bit + 1, middle)) {
+                return true;
+            }
+        }
+    }
+#endif
+    return contains_scalar(haystack, needle, pos);
+}
+
+std::string_view ascii_search_backend() {
+#if defined(BAYESELO_ASCII_SEARCH_SSE2)
+    return "sse2";
+#elif defined(BAYESELO_ASCII_SEARCH_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace bayeselo
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string_view>
+
+namespace bayeselo {
+
+// True when haystack contains needle, ignoring ASCII case. needle must already be lowercase; bytes
+// outside 'A'-'Z' compare exactly, as with std::tolower in the C locale.
+bool contains_ascii_nocase(std::string_view haystack, std::string_view lowered_needle);
+
+// Name of the block matcher compiled in ("sse2", "neon" or "scalar").
+std::string_view ascii_search_backend();
+
+} // namespace bayeselo
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace bayeselo {
+
+// Fixed-capacity multi-producer/multi-consumer queue. Each slot carries a sequence number telling
+// producers and consumers whose turn it is, so try_push/try_pop take no lock (Vyukov's bounded
+// queue). push/pop block on a full/empty queue; that is what gives a pipeline stage backpressure.
+template <typename T>
+class BoundedQueue {
+public:
+    // capacity is rounded up to a power of two.
+    explicit BoundedQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mask_ = size - 1;
+        cells_ = std::make_unique<Cell[]>(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    // Moves from value only on success.
+    bool try_push(T& value) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    signal(pushes_);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& out) {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.value);
+                    cell.value = T{};
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    signal(pops_);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Blocks while the queue is full.
+    void push(T value) {
+        while (true) {
+            const auto seen = pops_.load(std::memory_order_acquire);
+            if (try_push(value)) {
+                return;
+            }
+            pops_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    // Blocks while the queue is empty.
+    T pop() {
+        T out{};
+        while (true) {
+            const auto seen = pushes_.load(std::memory_order_acquire);
+            if (try_pop(out)) {
+                return out;
+            }
+            pushes_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic_size_t sequence{0};
+        T value{};
+    };
+
+    // Blocked push/pop callers sleep on these counters; every successful operation bumps one.
+    static void signal(std::atomic_uint32_t& counter) {
+        counter.fetch_add(1, std::memory_order_release);
+        counter.notify_all();
+    }
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_{0};
+    alignas(64) std::atomic_size_t tail_{0};
+    alignas(64) std::atomic_size_t head_{0};
+    alignas(64) std::atomic_uint32_t pushes_{0};
+    alignas(64) std::atomic_uint32_t pops_{0};
+};
+
+} // namespace bayeselo
@@ -0,0 +1,21 @@
+#include "buffer_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace bayeselo {
+
+BufferPool::BufferPool(std::size_t buffers) : buffers_(std::max<std::size_t>(buffers, 1)), free_(buffers_) {
+    for (std::size_t i = 0; i < buffers_; ++i) {
+        free_.push(std::vector<char>{});
+    }
+}
+
+std::vector<char> BufferPool::acquire() { return free_.pop(); }
+
+void BufferPool::release(std::vector<char> buffer) {
+    buffer.clear();
+    free_.push(std::move(buffer));
+}
+
+} // namespace bayeselo
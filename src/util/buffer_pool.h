@@ -0,0 +1,29 @@
+#pragma once
+
+#include "util/bounded_queue.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace bayeselo {
+
+// A fixed set of byte buffers handed out and returned by pipeline stages. acquire() blocks while
+// every buffer is in use, so the number of buffers bounds how far a reader can run ahead of its
+// consumers, and returned buffers keep their capacity: once warm, a stream is read without
+// allocating.
+class BufferPool {
+public:
+    explicit BufferPool(std::size_t buffers);
+
+    std::size_t size() const { return buffers_; }
+
+    std::vector<char> acquire();
+    // Clears buffer (keeping its capacity) and makes it available again.
+    void release(std::vector<char> buffer);
+
+private:
+    std::size_t buffers_;
+    BoundedQueue<std::vector<char>> free_;
+};
+
+} // namespace bayeselo
@@ -0,0 +1,151 @@
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#if defined(__linux__)
+#define BAYESELO_HAVE_AFFINITY 1
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace bayeselo {
+
+std::size_t CpuTopology::cpu_count() const {
+    std::size_t count = 0;
+    for (const auto& node : nodes) {
+        count += node.size();
+    }
+    return count;
+}
+
+std::optional<std::vector<unsigned>> parse_cpu_list(std::string_view text) {
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+        text.remove_suffix(1);
+    }
+    std::vector<unsigned> cpus;
+    if (text.empty()) {
+        return cpus;
+    }
+    const char* p = text.data();
+    const char* const end = text.data() + text.size();
+    while (true) {
+        unsigned first = 0;
+        auto [after_first, ec] = std::from_chars(p, end, first);
+        if (ec != std::errc{}) {
+            return std::nullopt;
+        }
+        unsigned last = first;
+        p = after_first;
+        if (p != end && *p == '-') {
+            auto [after_last, ec_last] = std::from_chars(p + 1, end, last);
+            if (ec_last != std::errc{} || last < first) {
+                return std::nullopt;
+            }
+            p = after_last;
+        }
+        for (unsigned cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+        if (p == end) {
+            break;
+        }
+        if (*p != ',') {
+            return std::nullopt;
+        }
+        ++p;
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+namespace {
+
+// Only a CPU count: the ids are not known to be ones this process may run on.
+CpuTopology fallback_topology() {
+    CpuTopology topology;
+    topology.nodes.emplace_back();
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned cpu = 0; cpu < cpus; ++cpu) {
+        topology.nodes.back().push_back(cpu);
+    }
+    return topology;
+}
+
+} // namespace
+
+CpuTopology detect_cpu_topology() {
+#ifdef BAYESELO_HAVE_AFFINITY
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (::sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return fallback_topology();
+    }
+    std::vector<std::pair<unsigned, std::vector<unsigned>>> found; // (node id, cpus)
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it("/sys/devices/system/node", ec), end; !ec && it != end; it.increment(ec)) {
+        const auto name = it->path().filename().string();
+        unsigned node = 0;
+        if (!name.starts_with("node") ||
+            std::from_chars(name.data() + 4, name.data() + name.size(), node).ptr != name.data() + name.size()) {
+            continue;
+        }
+        std::ifstream in(it->path() / "cpulist");
+        std::string line;
+        std::getline(in, line);
+        auto cpus = parse_cpu_list(line);
+        if (!cpus) {
+            continue;
+        }
+        std::erase_if(*cpus, [&](unsigned cpu) { return cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed); });
+        if (!cpus->empty()) {
+            found.emplace_back(node, std::move(*cpus));
+        }
+    }
+    CpuTopology topology;
+    topology.from_affinity = true;
+    if (found.empty()) {
+        // No NUMA information: one node with every CPU of the mask.
+        auto& node = topology.nodes.emplace_back();
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                node.push_back(cpu);
+            }
+        }
+        if (node.empty()) {
+            return fallback_topology();
+        }
+        return topology;
+    }
+    std::sort(found.begin(), found.end());
+    for (auto& [node, cpus] : found) {
+        topology.nodes.push_back(std::move(cpus));
+    }
+    return topology;
+#else
+    return fallback_topology();
+#endif
+}
+
+bool pin_current_thread(unsigned cpu) {
+#ifdef BAYESELO_HAVE_AFFINITY
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace bayeselo
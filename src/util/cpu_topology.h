@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace bayeselo {
+
+// CPUs this process may run on, grouped by NUMA node.
+struct CpuTopology {
+    std::vector<std::vector<unsigned>> nodes; // CPU ids per node, ascending; never empty
+    // True when the ids are the CPUs of the process's affinity mask. Otherwise they only count
+    // hardware_concurrency CPUs and must not be used for pinning.
+    bool from_affinity{false};
+
+    std::size_t cpu_count() const;
+};
+
+// Reads the nodes from /sys/devices/system/node on Linux, keeping only CPUs in the process's
+// affinity mask (e.g. a container's cpuset). Without sysfs, a single node holding the mask's CPUs.
+// Elsewhere, or when the mask cannot be read, a single node counting hardware_concurrency CPUs,
+// with from_affinity false.
+CpuTopology detect_cpu_topology();
+
+// Parses a kernel CPU list such as "0-3,8,10-11"; nullopt when malformed.
+std::optional<std::vector<unsigned>> parse_cpu_list(std::string_view text);
+
+// Restricts the calling thread to cpu; false when unsupported on this platform or refused.
+bool pin_current_thread(unsigned cpu);
+
+} // namespace bayeselo
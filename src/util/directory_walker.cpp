@@ -0,0 +1,56 @@
+#include "directory_walker.h"
+
+#include <utility>
+
+namespace bayeselo {
+
+DirectoryWalker::DirectoryWalker(ThreadPool& pool, ErrorCallback on_error) : pool_(pool), state_(std::make_shared<State>()) {
+    state_->on_error = std::move(on_error);
+}
+
+void DirectoryWalker::walk(const std::filesystem::path& root, FileCallback on_file) {
+    auto callback = std::make_shared<const FileCallback>(std::move(on_file));
+    {
+        std::scoped_lock lock(state_->mutex);
+        ++state_->pending;
+    }
+    pool_.enqueue([&pool = pool_, state = state_, callback, root]() { list_directory(pool, state, callback, root); });
+}
+
+void DirectoryWalker::wait() {
+    std::unique_lock lock(state_->mutex);
+    state_->done_cv.wait(lock, [this]() { return state_->pending == 0; });
+}
+
+void DirectoryWalker::list_directory(ThreadPool& pool,
+                                     const std::shared_ptr<State>& state,
+                                     const std::shared_ptr<const FileCallback>& on_file,
+                                     const std::filesystem::path& dir) {
+    std::error_code ec;
+    std::filesystem::directory_iterator it(dir, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        std::error_code type_ec;
+        const auto status = it->symlink_status(type_ec);
+        if (type_ec) {
+            continue;
+        }
+        if (std::filesystem::is_directory(status)) {
+            {
+                std::scoped_lock lock(state->mutex);
+                ++state->pending;
+            }
+            pool.enqueue([&pool, state, on_file, sub = it->path()]() { list_directory(pool, state, on_file, sub); });
+        } else if (it->is_regular_file(type_ec)) {
+            (*on_file)(*it);
+        }
+    }
+    if (ec && state->on_error) {
+        state->on_error(dir, ec);
+    }
+    std::scoped_lock lock(state->mutex);
+    if (--state->pending == 0) {
+        state->done_cv.notify_all();
+    }
+}
+
+} // namespace bayeselo
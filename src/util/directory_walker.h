@@ -0,0 +1,51 @@
+#pragma once
+
+#include "util/thread_pool.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+
+namespace bayeselo {
+
+// Walks directory trees on a ThreadPool. Every directory is listed by its own task, so sibling
+// subtrees are scanned in parallel and files are reported while the rest of the tree is still being
+// discovered. Symlinked directories are not followed (as with recursive_directory_iterator).
+class DirectoryWalker {
+public:
+    // Called from pool workers, possibly concurrently, for every regular file found.
+    using FileCallback = std::function<void(const std::filesystem::directory_entry&)>;
+    using ErrorCallback = std::function<void(const std::filesystem::path&, const std::error_code&)>;
+
+    DirectoryWalker(ThreadPool& pool, ErrorCallback on_error);
+    DirectoryWalker(const DirectoryWalker&) = delete;
+    DirectoryWalker& operator=(const DirectoryWalker&) = delete;
+
+    // Starts listing root; returns immediately.
+    void walk(const std::filesystem::path& root, FileCallback on_file);
+    // Blocks until every directory queued so far has been listed. Parse tasks the callbacks enqueued
+    // may still be running.
+    void wait();
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        std::size_t pending{0};
+        ErrorCallback on_error;
+    };
+
+    static void list_directory(ThreadPool& pool,
+                               const std::shared_ptr<State>& state,
+                               const std::shared_ptr<const FileCallback>& on_file,
+                               const std::filesystem::path& dir);
+
+    ThreadPool& pool_;
+    std::shared_ptr<State> state_;
+};
+
+} // namespace bayeselo
@@ -2,6 +2,7 @@
 
 #include <cctype>
 #include <cerrno>
+#include <charconv>
 #include <cstdlib>
 #include <stdexcept>
 #include <string>
@@ -50,4 +51,125 @@ double parse_duration_to_seconds(std::string_view value) {
     }
 }
 
+namespace {
+
+// Non-negative number with an optional h/m/s suffix; the whole of text must be consumed.
+bool parse_amount(std::string_view text, double& seconds) {
+    if (text.empty() || !(std::isdigit(static_cast<unsigned char>(text.front())) || text.front() == '.')) {
+        return false;
+    }
+    double scale = 1.0;
+    switch (text.back()) {
+    case 'h':
+    case 'H':
+        scale = 3600.0;
+        text.remove_suffix(1);
+        break;
+    case 'm':
+    case 'M':
+        scale = 60.0;
+        text.remove_suffix(1);
+        break;
+    case 's':
+    case 'S':
+        text.remove_suffix(1);
+        break;
+    default:
+        break;
+    }
+    double number = 0.0;
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), number, std::chars_format::fixed);
+    if (ec != std::errc{} || end != text.data() + text.size()) {
+        return false;
+    }
+    seconds = number * scale;
+    return true;
+}
+
+bool parse_period(std::string_view text, TimeControlPeriod& period) {
+    if (const auto slash = text.find('/'); slash != std::string_view::npos) {
+        const auto moves = text.substr(0, slash);
+        const auto [end, ec] = std::from_chars(moves.data(), moves.data() + moves.size(), period.moves);
+        if (ec != std::errc{} || end != moves.data() + moves.size() || period.moves == 0) {
+            return false;
+        }
+        text.remove_prefix(slash + 1);
+    }
+    if (const auto plus = text.find('+'); plus != std::string_view::npos) {
+        if (!parse_amount(text.substr(plus + 1), period.increment)) {
+            return false;
+        }
+        text = text.substr(0, plus);
+    }
+    return parse_amount(text, period.seconds);
+}
+
+} // namespace
+
+double TimeControl::estimate_seconds(std::uint32_t plies) const {
+    if (sandclock || period_count == 0) {
+        return periods[0].seconds;
+    }
+    const std::uint32_t side_moves = plies / 2 + plies % 2;
+    std::uint32_t done = 0;
+    double total = 0.0;
+    for (std::size_t i = 0;; ++i) {
+        const auto& period = periods[i];
+        const std::uint32_t remaining = side_moves - done;
+        total += period.seconds;
+        if (period.moves == 0 || remaining <= period.moves) {
+            return total + period.increment * remaining;
+        }
+        if (i + 1 == period_count) {
+            const std::uint32_t repeats = (remaining - 1) / period.moves;
+            return total + period.seconds * repeats + period.increment * remaining;
+        }
+        total += period.increment * period.moves;
+        done += period.moves;
+    }
+}
+
+bool TimeControl::depends_on_plies() const {
+    if (sandclock) {
+        return false;
+    }
+    for (std::size_t i = 0; i < period_count; ++i) {
+        if (periods[i].moves != 0 || periods[i].increment != 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TimeControlResult parse_time_control(std::string_view value) noexcept {
+    if (value == "?") {
+        return TimeControlError::Unknown;
+    }
+    if (value == "-") {
+        return TimeControlError::Unlimited;
+    }
+    TimeControl control;
+    if (!value.empty() && value.front() == '*') {
+        control.sandclock = true;
+        control.period_count = 1;
+        if (!parse_amount(value.substr(1), control.periods[0].seconds)) {
+            return TimeControlError::Malformed;
+        }
+        return control;
+    }
+    while (true) {
+        if (control.period_count == TimeControl::kMaxPeriods) {
+            return TimeControlError::Malformed;
+        }
+        const auto colon = value.find(':');
+        if (!parse_period(value.substr(0, colon), control.periods[control.period_count++])) {
+            return TimeControlError::Malformed;
+        }
+        if (colon == std::string_view::npos) {
+            return control;
+        }
+        value.remove_prefix(colon + 1);
+    }
+}
+
 } // namespace bayeselo
@@ -0,0 +1,177 @@
+#include "file_watcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <optional>
+#include <system_error>
+#include <thread>
+
+#if defined(__linux__)
+#define BAYESELO_HAVE_INOTIFY 1
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace bayeselo {
+
+namespace {
+
+#ifdef BAYESELO_HAVE_INOTIFY
+// Writes, plus the file being renamed, deleted or unlinked (IN_ATTRIB covers the link count).
+constexpr std::uint32_t kFileMask = IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB;
+// A new file appearing under a watched name.
+constexpr std::uint32_t kDirectoryMask = IN_CREATE | IN_MOVED_TO;
+#endif
+
+std::filesystem::path parent_of(const std::filesystem::path& file) {
+    auto parent = file.parent_path();
+    return parent.empty() ? std::filesystem::path(".") : parent;
+}
+
+} // namespace
+
+FileWatcher::FileWatcher() {
+#ifdef BAYESELO_HAVE_INOTIFY
+    inotify_fd_ = ::inotify_init1(IN_CLOEXEC);
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef BAYESELO_HAVE_INOTIFY
+    if (inotify_fd_ >= 0) {
+        ::close(inotify_fd_);
+    }
+#endif
+}
+
+bool FileWatcher::add(const std::filesystem::path& file) {
+    std::error_code ec;
+    Watched watched{file, -1, -1, std::filesystem::file_size(file, ec), {}};
+    if (ec) {
+        return false;
+    }
+    watched.last_write = std::filesystem::last_write_time(file, ec);
+#ifdef BAYESELO_HAVE_INOTIFY
+    if (inotify_fd_ >= 0) {
+        watched.descriptor = ::inotify_add_watch(inotify_fd_, file.c_str(), kFileMask);
+        // Several files in one directory share its watch (inotify returns the same descriptor).
+        watched.directory_descriptor = ::inotify_add_watch(inotify_fd_, parent_of(file).c_str(), kDirectoryMask);
+        if (watched.descriptor < 0 || watched.directory_descriptor < 0) {
+            return false;
+        }
+    }
+#endif
+    files_.push_back(std::move(watched));
+    return true;
+}
+
+bool FileWatcher::rewatch(std::size_t index) {
+#ifdef BAYESELO_HAVE_INOTIFY
+    auto& watched = files_[index];
+    const int descriptor = ::inotify_add_watch(inotify_fd_, watched.path.c_str(), kFileMask);
+    if (descriptor < 0) {
+        return false;
+    }
+    if (watched.descriptor >= 0 && watched.descriptor != descriptor) {
+        // The replaced file may still be open elsewhere; stop hearing about it.
+        ::inotify_rm_watch(inotify_fd_, watched.descriptor);
+    }
+    watched.descriptor = descriptor;
+    return true;
+#else
+    (void)index;
+    return false;
+#endif
+}
+
+std::vector<std::size_t> FileWatcher::poll_files() {
+    std::vector<std::size_t> changed;
+    for (std::size_t i = 0; i < files_.size(); ++i) {
+        std::error_code size_ec;
+        std::error_code time_ec;
+        const auto size = std::filesystem::file_size(files_[i].path, size_ec);
+        const auto write = std::filesystem::last_write_time(files_[i].path, time_ec);
+        if (!size_ec && !time_ec && (size != files_[i].last_size || write != files_[i].last_write)) {
+            files_[i].last_size = size;
+            files_[i].last_write = write;
+            changed.push_back(i);
+        }
+    }
+    return changed;
+}
+
+std::vector<std::size_t> FileWatcher::wait(std::chrono::milliseconds settle) {
+    if (files_.empty()) {
+        return {};
+    }
+#ifdef BAYESELO_HAVE_INOTIFY
+    if (inotify_fd_ >= 0) {
+        using Clock = std::chrono::steady_clock;
+        std::vector<std::size_t> changed;
+        auto mark = [&](std::size_t i) {
+            if (std::find(changed.begin(), changed.end(), i) == changed.end()) {
+                changed.push_back(i);
+            }
+        };
+        alignas(inotify_event) char buffer[4096];
+        std::optional<Clock::time_point> deadline; // set by the first event of the batch
+        while (true) {
+            int timeout = -1; // block for the first event
+            if (deadline) {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(*deadline - Clock::now());
+                if (left.count() <= 0) {
+                    break;
+                }
+                timeout = static_cast<int>(std::min(settle, left).count());
+            }
+            pollfd pfd{inotify_fd_, POLLIN, 0};
+            const int ready = ::poll(&pfd, 1, timeout);
+            if (ready <= 0) {
+                if (ready < 0 && errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            const ssize_t length = ::read(inotify_fd_, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                for (std::size_t i = 0; i < files_.size(); ++i) {
+                    auto& watched = files_[i];
+                    if (event->len > 0 && watched.directory_descriptor == event->wd &&
+                        watched.path.filename() == std::filesystem::path(event->name)) {
+                        // A new file took the name: follow it from now on.
+                        if (rewatch(i)) {
+                            mark(i);
+                        }
+                    } else if (watched.descriptor == event->wd) {
+                        if (event->mask & IN_IGNORED) {
+                            watched.descriptor = -1; // deleted; wait for a replacement in the directory
+                        } else {
+                            mark(i);
+                        }
+                    }
+                }
+            }
+            if (!changed.empty() && !deadline) {
+                deadline = Clock::now() + settle * kMaxBatchSettles;
+            }
+        }
+        std::sort(changed.begin(), changed.end());
+        return changed;
+    }
+#endif
+    while (true) {
+        std::this_thread::sleep_for(settle);
+        auto changed = poll_files();
+        if (!changed.empty()) {
+            return changed;
+        }
+    }
+}
+
+} // namespace bayeselo
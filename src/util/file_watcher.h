@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace bayeselo {
+
+// Waits for watched files to be written to, truncated or replaced (renamed over, or deleted and
+// created again). Uses inotify on Linux, watching each file and its directory; elsewhere (or when
+// inotify is unavailable) it polls the file sizes and modification times once per settle interval.
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // False when the file cannot be watched (missing, or out of inotify watches).
+    bool add(const std::filesystem::path& file);
+    std::size_t size() const { return files_.size(); }
+
+    // Blocks until at least one file changed, then keeps collecting events until none arrive for
+    // settle, so that a burst of appends is handled as one batch. A batch never runs longer than
+    // kMaxBatchSettles settle intervals, even while a writer keeps appending. Returns the indices
+    // (in add order) of changed files.
+    std::vector<std::size_t> wait(std::chrono::milliseconds settle);
+
+    static constexpr int kMaxBatchSettles = 4;
+
+private:
+    struct Watched {
+        std::filesystem::path path;
+        int descriptor{-1};           // watch on the file itself; -1 once it is gone
+        int directory_descriptor{-1}; // watch on its directory, for a replacement appearing
+        std::uintmax_t last_size{0};
+        std::filesystem::file_time_type last_write{};
+    };
+
+    std::vector<std::size_t> poll_files();
+    // Watches the file now at files_[index].path (after a replacement); false if there is none.
+    bool rewatch(std::size_t index);
+
+    int inotify_fd_{-1};
+    std::vector<Watched> files_;
+};
+
+} // namespace bayeselo
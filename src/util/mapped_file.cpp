@@ -0,0 +1,110 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BAYESELO_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bayeselo {
+
+namespace {
+
+#ifdef BAYESELO_HAVE_MMAP
+std::size_t page_size() {
+    static const std::size_t size = [] {
+        long value = ::sysconf(_SC_PAGESIZE);
+        return value > 0 ? static_cast<std::size_t>(value) : std::size_t{4096};
+    }();
+    return size;
+}
+#endif
+
+} // namespace
+
+MappedFile::MappedFile(std::filesystem::path path, const char* data, std::size_t size)
+    : path_(std::move(path)), data_(data), size_(size) {}
+
+MappedFile::~MappedFile() {
+#ifdef BAYESELO_HAVE_MMAP
+    if (data_ != nullptr && size_ > 0) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::filesystem::path& file) {
+#ifdef BAYESELO_HAVE_MMAP
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return nullptr;
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+        // mmap rejects zero-length mappings; an empty view is all an empty file needs.
+        ::close(fd);
+        return std::shared_ptr<const MappedFile>(new MappedFile(file, nullptr, 0));
+    }
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps its own reference to the file
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    // Only honoured on filesystems with large-folio page cache support; harmless elsewhere.
+    ::madvise(data, size, MADV_HUGEPAGE);
+#endif
+    return std::shared_ptr<const MappedFile>(new MappedFile(file, static_cast<const char*>(data), size));
+#else
+    (void)file;
+    return nullptr;
+#endif
+}
+
+void MappedFile::advise_sequential(std::size_t start, std::size_t end) const {
+#ifdef BAYESELO_HAVE_MMAP
+    end = std::min(end, size_);
+    if (data_ == nullptr || start >= end) {
+        return;
+    }
+    const std::size_t aligned_start = start - start % page_size();
+    void* addr = const_cast<char*>(data_ + aligned_start);
+    ::madvise(addr, end - aligned_start, MADV_SEQUENTIAL);
+    ::madvise(addr, end - aligned_start, MADV_WILLNEED);
+#else
+    (void)start;
+    (void)end;
+#endif
+}
+
+void MappedFile::release(std::size_t start, std::size_t end) const {
+#ifdef BAYESELO_HAVE_MMAP
+    end = std::min(end, size_);
+    if (data_ == nullptr || start >= end) {
+        return;
+    }
+    const std::size_t page = page_size();
+    // Round inwards so pages shared with a neighbouring chunk stay resident.
+    const std::size_t first = (start + page - 1) / page * page;
+    const std::size_t last = end == size_ ? end : end / page * page;
+    if (first >= last) {
+        return;
+    }
+    ::madvise(const_cast<char*>(data_ + first), last - first, MADV_DONTNEED);
+#else
+    (void)start;
+    (void)end;
+#endif
+}
+
+} // namespace bayeselo
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace bayeselo {
+
+// Read-only memory mapping of a whole file. A file is mapped once and shared by every chunk
+// parsed from it; the mapping is released when the last reference goes away.
+class MappedFile {
+public:
+    // Returns nullptr when the file cannot be mapped (missing, not a regular file, or no mmap
+    // support on this platform); callers fall back to the ifstream path in that case.
+    static std::shared_ptr<const MappedFile> open(const std::filesystem::path& file);
+
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::filesystem::path& path() const { return path_; }
+    std::size_t size() const { return size_; }
+    std::string_view view() const { return {data_, size_}; }
+
+    // Hint that [start, end) is about to be read front to back.
+    void advise_sequential(std::size_t start, std::size_t end) const;
+    // Drop the page-cache residency of [start, end) from this mapping once a chunk is done with it.
+    // Only whole pages inside the range are released; the data is re-read on a later access.
+    void release(std::size_t start, std::size_t end) const;
+
+private:
+    MappedFile(std::filesystem::path path, const char* data, std::size_t size);
+
+    std::filesystem::path path_;
+    const char* data_{nullptr};
+    std::size_t size_{0};
+};
+
+// Keeps a MappedFile alive while views into [start, end) are in use and releases the range's pages
+// when destroyed, so a parsed chunk drops its input pages in one go once its games are consumed.
+class MappedRange {
+public:
+    MappedRange() = default;
+    MappedRange(std::shared_ptr<const MappedFile> file, std::size_t start, std::size_t end)
+        : file_(std::move(file)), start_(start), end_(end) {}
+    ~MappedRange() { reset(); }
+    MappedRange(MappedRange&& other) noexcept { *this = std::move(other); }
+    MappedRange& operator=(MappedRange&& other) noexcept {
+        if (this != &other) {
+            reset();
+            file_ = std::move(other.file_);
+            start_ = other.start_;
+            end_ = other.end_;
+        }
+        return *this;
+    }
+    MappedRange(const MappedRange&) = delete;
+    MappedRange& operator=(const MappedRange&) = delete;
+
+    std::string_view view() const { return file_ ? file_->view().substr(start_, end_ - start_) : std::string_view{}; }
+
+    void reset() {
+        if (file_) {
+            file_->release(start_, end_);
+            file_.reset();
+        }
+    }
+
+private:
+    std::shared_ptr<const MappedFile> file_;
+    std::size_t start_{0};
+    std::size_t end_{0};
+};
+
+} // namespace bayeselo
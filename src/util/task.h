@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bayeselo {
+
+// Move-only `void()` callable for ThreadPool. Callables up to kInlineSize bytes (a chunk task's
+// captures, a shared_ptr and an index, ...) are stored in place, so queueing them does not allocate;
+// larger ones fall back to the heap. Unlike std::function it accepts move-only captures.
+class Task {
+public:
+    static constexpr std::size_t kInlineSize = 56;
+
+    Task() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& fn) { // implicit, as for std::function
+        using Fn = std::decay_t<F>;
+        if constexpr (fits_inline<Fn>()) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(fn));
+            ops_ = &kInlineOps<Fn>;
+        } else {
+            ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(fn)));
+            ops_ = &kHeapOps<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept : ops_(other.ops_) {
+        if (ops_) {
+            ops_->move(storage_, other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops_) {
+                other.ops_->move(storage_, other.storage_);
+                ops_ = std::exchange(other.ops_, nullptr);
+            }
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { reset(); }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+    void operator()() { ops_->invoke(storage_); }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* to, void* from) noexcept; // leaves from destroyed
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr bool fits_inline() {
+        return sizeof(Fn) <= kInlineSize && alignof(Fn) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static constexpr Ops kInlineOps{
+        [](void* storage) { (*std::launder(static_cast<Fn*>(storage)))(); },
+        [](void* to, void* from) noexcept {
+            auto* source = std::launder(static_cast<Fn*>(from));
+            ::new (to) Fn(std::move(*source));
+            source->~Fn();
+        },
+        [](void* storage) noexcept { std::launder(static_cast<Fn*>(storage))->~Fn(); },
+    };
+    template <typename Fn>
+    static constexpr Ops kHeapOps{
+        [](void* storage) { (**std::launder(static_cast<Fn**>(storage)))(); },
+        [](void* to, void* from) noexcept { ::new (to) Fn*(*std::launder(static_cast<Fn**>(from))); },
+        [](void* storage) noexcept { delete *std::launder(static_cast<Fn**>(storage)); },
+    };
+
+    void reset() {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Ops* ops_{nullptr};
+};
+
+} // namespace bayeselo
@@ -1,16 +1,64 @@
 #include "thread_pool.h"
 
+#include "cpu_topology.h"
+
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <utility>
 
 namespace bayeselo {
 
-ThreadPool::ThreadPool(std::size_t threads) {
+namespace {
+
+// The pool and queue of the worker running on this thread, if any.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+
+} // namespace
+
+struct ThreadPool::RangeJob {
+    std::function<void(std::size_t)> body;
+    std::size_t grain{1};
+};
+
+ThreadPool::ThreadPool(std::size_t threads, bool pin_workers) {
     if (threads == 0) {
         threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
     }
+    // CPUs in node order; worker i takes the i-th (wrapping when there are more workers than CPUs).
+    std::vector<std::pair<std::size_t, unsigned>> cpus; // (node, cpu)
+    const auto topology = pin_workers ? detect_cpu_topology() : CpuTopology{};
+    // Without the affinity mask the ids are guesses (0..n-1 even in a container on CPUs 4-7): no pinning.
+    if (topology.from_affinity) {
+        for (std::size_t node = 0; node < topology.nodes.size(); ++node) {
+            for (const unsigned cpu : topology.nodes[node]) {
+                cpus.emplace_back(node, cpu);
+            }
+        }
+    }
+    std::vector<std::optional<unsigned>> worker_cpu(threads);
+    worker_node_.assign(threads, 0);
+    for (std::size_t i = 0; i < threads && !cpus.empty(); ++i) {
+        const auto& [node, cpu] = cpus[i % cpus.size()];
+        worker_cpu[i] = cpu;
+        worker_node_[i] = node;
+        node_count_ = std::max(node_count_, node + 1);
+    }
     for (std::size_t i = 0; i < threads; ++i) {
-        workers_.emplace_back([this](std::stop_token token) { worker(token); });
+        queues_.push_back(std::make_unique<WorkerQueue>());
+        auto& order = victims_.emplace_back();
+        for (const bool same_node : {true, false}) {
+            for (std::size_t k = 1; k < threads; ++k) {
+                const std::size_t victim = (i + k) % threads;
+                if ((worker_node_[victim] == worker_node_[i]) == same_node) {
+                    order.push_back(victim);
+                }
+            }
+        }
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, i, cpu = worker_cpu[i]](std::stop_token token) { worker(token, i, cpu); });
     }
 }
 
@@ -20,68 +68,163 @@ void ThreadPool::shutdown() {
     wait_for_completion();
     {
         std::scoped_lock lock(mutex_);
-        stopping_ = true;
+        stopping_.store(true);
     }
     cv_.notify_all();
     workers_.clear(); // jthreads join on destruction
 }
 
-void ThreadPool::enqueue(std::function<void()> task) {
-    {
-        std::scoped_lock lock(mutex_);
-        if (stopping_) {
-            return;
+std::size_t ThreadPool::current_node() const {
+    return current_pool == this ? worker_node_[current_queue] : 0;
+}
+
+std::size_t ThreadPool::home_queue() {
+    if (current_pool == this) {
+        return current_queue;
+    }
+    return next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+}
+
+void ThreadPool::push(std::size_t queue, Task task) {
+    auto& target = *queues_[queue];
+    std::scoped_lock lock(target.mutex);
+    target.tasks.push_back(std::move(task));
+}
+
+void ThreadPool::wake(std::size_t tasks) {
+    // Pairs with the sleeper count taken under mutex_ in worker(): either the sleeper sees the new
+    // queued_ in its wait predicate or we see it sleeping here.
+    if (sleepers_.load() == 0) {
+        return;
+    }
+    { std::scoped_lock lock(mutex_); }
+    if (tasks == 1) {
+        cv_.notify_one();
+    } else {
+        cv_.notify_all();
+    }
+}
+
+void ThreadPool::enqueue(Task task) {
+    if (stopping_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    unfinished_.fetch_add(1);
+    queued_.fetch_add(1);
+    push(home_queue(), std::move(task));
+    wake(1);
+}
+
+void ThreadPool::enqueue_bulk(std::vector<Task> tasks) {
+    if (tasks.empty() || stopping_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const std::size_t count = tasks.size();
+    unfinished_.fetch_add(count);
+    queued_.fetch_add(count);
+    if (current_pool == this) {
+        auto& own = *queues_[current_queue];
+        std::scoped_lock lock(own.mutex);
+        std::move(tasks.begin(), tasks.end(), std::back_inserter(own.tasks));
+    } else {
+        // Contiguous runs keep neighbouring tasks (e.g. adjacent chunks of a file) on one worker.
+        const std::size_t per_queue = (count + queues_.size() - 1) / queues_.size();
+        const std::size_t start = next_queue_.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t begin = 0, q = 0; begin < count; begin += per_queue, ++q) {
+            const std::size_t end = std::min(count, begin + per_queue);
+            auto& target = *queues_[(start + q) % queues_.size()];
+            std::scoped_lock lock(target.mutex);
+            std::move(tasks.begin() + static_cast<std::ptrdiff_t>(begin), tasks.begin() + static_cast<std::ptrdiff_t>(end),
+                      std::back_inserter(target.tasks));
+        }
+    }
+    wake(count);
+}
+
+void ThreadPool::enqueue_range_part(const std::shared_ptr<RangeJob>& job, std::size_t first, std::size_t last) {
+    enqueue([this, job, first, last]() mutable {
+        // Hand off the upper half until the rest is small; thieves take the largest halves first.
+        while (last - first > job->grain) {
+            const std::size_t middle = first + (last - first) / 2;
+            enqueue_range_part(job, middle, last);
+            last = middle;
+        }
+        for (std::size_t i = first; i < last; ++i) {
+            job->body(i);
         }
-        tasks_.push(std::move(task));
+    });
+}
+
+void ThreadPool::enqueue_range(std::size_t first, std::size_t last, std::size_t grain, std::function<void(std::size_t)> body) {
+    if (first >= last) {
+        return;
     }
-    cv_.notify_one();
+    auto job = std::make_shared<RangeJob>();
+    job->body = std::move(body);
+    job->grain = std::max<std::size_t>(1, grain);
+    enqueue_range_part(job, first, last);
 }
 
 void ThreadPool::wait_for_completion() {
     std::unique_lock lock(mutex_);
-    idle_cv_.wait(lock, [this]() { return tasks_.empty() && active_tasks_ == 0; });
+    idle_cv_.wait(lock, [this]() { return unfinished_.load() == 0; });
+}
+
+bool ThreadPool::try_pop(std::size_t own_queue, Task& task) {
+    {
+        auto& own = *queues_[own_queue];
+        std::scoped_lock lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    for (const std::size_t index : victims_[own_queue]) {
+        auto& victim = *queues_[index];
+        std::scoped_lock lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
 }
 
-void ThreadPool::worker(std::stop_token token) {
+void ThreadPool::run(Task& task) {
+    task();
+    task = Task{}; // release captures before the pool can be seen idle
+    assert(unfinished_.load() > 0);
+    if (unfinished_.fetch_sub(1) == 1) {
+        std::scoped_lock lock(mutex_);
+        idle_cv_.notify_all();
+    }
+}
+
+void ThreadPool::worker(std::stop_token token, std::size_t index, std::optional<unsigned> cpu) {
     // stopping_ controls logical pool shutdown and enqueue suppression; stop_token
     // enables cancellation of the cv_.wait call when jthreads are destroyed.
+    if (cpu) {
+        pin_current_thread(*cpu); // best effort: an unpinned worker still works
+    }
+    current_pool = this;
+    current_queue = index;
     while (!token.stop_requested()) {
-        std::function<void()> task;
-        {
-            std::unique_lock lock(mutex_);
-            cv_.wait(lock, token, [this, &token] { return token.stop_requested() || stopping_ || !tasks_.empty(); });
-            if (token.stop_requested()) {
-                break;
-            }
-            if (stopping_ && tasks_.empty()) {
-                break;
-            }
-            assert(!tasks_.empty());
-            task = std::move(tasks_.front());
-            tasks_.pop();
-            ++active_tasks_;
+        Task task;
+        if (try_pop(index, task)) {
+            run(task);
+            continue;
         }
-
-        if (task) {
-            task();
+        std::unique_lock lock(mutex_);
+        sleepers_.fetch_add(1);
+        cv_.wait(lock, token, [this] { return stopping_.load() || queued_.load() > 0; });
+        sleepers_.fetch_sub(1);
+        if (stopping_.load() && queued_.load() == 0) {
+            break;
         }
-
-        {
-            std::scoped_lock lock(mutex_);
-            assert(active_tasks_ > 0);
-            --active_tasks_;
-            if (tasks_.empty() && active_tasks_ == 0) {
-                idle_cv_.notify_all();
-                if (stopping_) {
-                    cv_.notify_all();
-                }
-            }
-        }
-    }
-    // ensure idle waiters can unblock if we exit while tasks are done
-    std::scoped_lock lock(mutex_);
-    if (tasks_.empty() && active_tasks_ == 0) {
-        idle_cv_.notify_all();
     }
 }
 
@@ -1,34 +1,80 @@
 #pragma once
 
+#include "util/task.h"
+
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
 #include <stop_token>
 #include <thread>
 #include <vector>
 
 namespace bayeselo {
 
+// Work-stealing pool: every worker owns a deque, runs its own tasks newest first and, when it runs
+// dry, steals the oldest task of another worker. Tasks enqueued from a worker go to its own deque;
+// tasks from other threads are spread round-robin.
+//
+// With pin_workers, each worker is bound to one CPU, filling NUMA nodes one after another (so a
+// pool no larger than a node stays on it), and steals from workers on its own node first. Memory a
+// pinned worker allocates and touches first is then placed on its node by the kernel.
 class ThreadPool {
 public:
-    explicit ThreadPool(std::size_t threads);
+    explicit ThreadPool(std::size_t threads, bool pin_workers = false);
     ~ThreadPool();
 
-    void enqueue(std::function<void()> task);
+    // Number of NUMA nodes the workers were placed on (1 unless pinned), and the node of the
+    // calling worker (0 for threads outside the pool).
+    std::size_t node_count() const { return node_count_; }
+    std::size_t current_node() const;
+
+    void enqueue(Task task);
+    // Queues many tasks with one wake-up; from outside the pool they are dealt out in contiguous runs
+    // (used for the member groups of a BGZF file).
+    void enqueue_bulk(std::vector<Task> tasks);
+    // Runs body(i) for every i in [first, last); returns immediately like enqueue. The range is one
+    // task that splits itself in halves down to grain indices, so idle workers steal the far end of
+    // a long range instead of waiting on whoever holds it. There is no blocking parallel_for: follow
+    // with wait_for_completion, after queueing whatever else should overlap with the range.
+    void enqueue_range(std::size_t first, std::size_t last, std::size_t grain, std::function<void(std::size_t)> body);
     void wait_for_completion();
     void shutdown();
 
 private:
-    void worker(std::stop_token token);
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    struct RangeJob;
+
+    void worker(std::stop_token token, std::size_t index, std::optional<unsigned> cpu);
+    void push(std::size_t queue, Task task);
+    void wake(std::size_t tasks);
+    // Pops from own_queue (newest first), else steals from the others (oldest first, nearest first).
+    bool try_pop(std::size_t own_queue, Task& task);
+    void run(Task& task);
+    // Index of the calling worker's queue, or any queue for threads outside the pool.
+    std::size_t home_queue();
+    void enqueue_range_part(const std::shared_ptr<RangeJob>& job, std::size_t first, std::size_t last);
 
-    std::mutex mutex_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::size_t> worker_node_;
+    std::vector<std::vector<std::size_t>> victims_; // steal order per worker: own node first
+    std::size_t node_count_{1};
+    std::atomic_size_t queued_{0};     // tasks sitting in queues_
+    std::atomic_size_t unfinished_{0}; // queued or running
+    std::atomic_size_t sleepers_{0};
+    std::atomic_size_t next_queue_{0};
+    std::atomic_bool stopping_{false};
+    std::mutex mutex_; // guards sleeping and idle waits only
     std::condition_variable_any cv_;
     std::condition_variable_any idle_cv_;
-    std::queue<std::function<void()>> tasks_;
     std::vector<std::jthread> workers_;
-    bool stopping_{false};
-    std::size_t active_tasks_{0};
 };
 
 } // namespace bayeselo
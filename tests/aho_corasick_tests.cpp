@@ -0,0 +1,50 @@
+#include "util/aho_corasick.h"
+#include "util/ascii_search.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+int main() {
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+
+    const bayeselo::AhoCorasick engines({"stockfish", "Leela", "fish 1", "he"});
+    if (!engines.contains_any("Stockfish 16")) return fail("whole pattern at the start");
+    if (!engines.contains_any("lc0 (LEELA)")) return fail("case-insensitive match of a mixed-case pattern");
+    if (!engines.contains_any("Chess Tiger")) return fail("short pattern inside a name");
+    if (!engines.contains_any("Koifish 1.0")) return fail("match found through a failure link");
+    if (engines.contains_any("Komodo Dragon")) return fail("no pattern matches");
+    if (bayeselo::AhoCorasick(std::vector<std::string>{}).contains_any("anything")) return fail("no patterns match nothing");
+    if (!bayeselo::AhoCorasick({""}).contains_any("anything")) return fail("an empty pattern matches everything");
+
+    // Random pattern sets over a small alphabet against one substring search per pattern.
+    std::mt19937 rng(2024);
+    const std::string alphabet = "abcAB 1\xC4";
+    auto random_text = [&](std::size_t size) {
+        std::string text(size, ' ');
+        for (auto& ch : text) ch = alphabet[rng() % alphabet.size()];
+        return text;
+    };
+    for (int round = 0; round < 2000; ++round) {
+        std::vector<std::string> patterns;
+        const std::size_t count = 1 + rng() % (round % 10 == 0 ? 300 : 8);
+        for (std::size_t i = 0; i < count; ++i) patterns.push_back(random_text(1 + rng() % 6));
+        const bayeselo::AhoCorasick automaton(patterns);
+        for (int probe = 0; probe < 10; ++probe) {
+            const std::string text = random_text(rng() % 40);
+            const bool expected = std::any_of(patterns.begin(), patterns.end(), [&](std::string pattern) {
+                for (auto& ch : pattern) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+                return bayeselo::contains_ascii_nocase(text, pattern);
+            });
+            if (automaton.contains_any(text) != expected) return fail("mismatch for text \"" + text + "\"");
+        }
+    }
+    std::cout << "aho-corasick tests passed\n";
+    return 0;
+}
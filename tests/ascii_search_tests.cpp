@@ -0,0 +1,65 @@
+#include "util/ascii_search.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace {
+
+bool reference(std::string_view haystack, std::string_view needle) {
+    return std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+           }) != haystack.end();
+}
+
+std::string lowered(std::string text) {
+    for (auto& ch : text) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    return text;
+}
+
+} // namespace
+
+int main() {
+    using bayeselo::contains_ascii_nocase;
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << " (backend " << bayeselo::ascii_search_backend() << ")\n";
+        return 1;
+    };
+
+    if (!contains_ascii_nocase("Stockfish 16.1 NNUE", "stockfish")) return fail("prefix match");
+    if (!contains_ascii_nocase("Engine-STOCKFISH", "stockfish")) return fail("suffix match");
+    if (!contains_ascii_nocase("anything", "")) return fail("empty needle matches");
+    if (contains_ascii_nocase("Stock", "stockfish")) return fail("needle longer than haystack");
+    if (contains_ascii_nocase("Leela Chess Zero with a rather long name", "stockfish")) return fail("false match");
+    if (!contains_ascii_nocase("a rather long player name ending in x", "x")) return fail("single byte needle at the end");
+    // Only ASCII letters fold: '@' (0x40) and '[' (0x5B) sit next to 'A' and 'Z', 0xC4 is not a letter here.
+    if (contains_ascii_nocase("@@@@@@@@@@@@@@@@@@@@[[[[", "````")) return fail("'@' must not fold to '`'");
+    if (contains_ascii_nocase("\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4\xC4", "\xE4\xE4")) return fail("non-ASCII bytes must not fold");
+    if (!contains_ascii_nocase("M\xC3\xBCller vs. somebody else entirely", "m\xC3\xBCller")) return fail("UTF-8 bytes compare exactly");
+
+    // Random haystacks over a small alphabet (so matches are common) against a std::search reference,
+    // across lengths that cover the block loop, its tail and needles longer than one block.
+    std::mt19937 rng(12345);
+    const std::string alphabet = "aAbB@[`{ \xC4\xE4";
+    auto random_text = [&](std::size_t size) {
+        std::string text(size, ' ');
+        for (auto& ch : text) ch = alphabet[rng() % alphabet.size()];
+        return text;
+    };
+    for (int round = 0; round < 20000; ++round) {
+        const std::string haystack = random_text(rng() % 80);
+        std::string needle = lowered(random_text(1 + rng() % (round % 10 == 0 ? 24 : 4)));
+        if (!haystack.empty() && rng() % 2 == 0) {
+            const std::size_t at = rng() % haystack.size();
+            needle = lowered(haystack.substr(at, 1 + rng() % 20));
+        }
+        if (contains_ascii_nocase(haystack, needle) != reference(haystack, needle)) {
+            return fail("mismatch for haystack \"" + haystack + "\" and needle \"" + needle + "\"");
+        }
+    }
+    std::cout << "ascii search tests passed\n";
+    return 0;
+}
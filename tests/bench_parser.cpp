@@ -72,6 +72,8 @@ void write_synthetic_pgn(const std::filesystem::path& path, std::size_t target_b
 
 int main(int argc, char** argv) {
     bool keep_file = false;
+    bool use_mmap = true;
+    bayeselo::ParseOptions parse_options{false}; // mirror the CLI default: count plies, drop moves
     std::size_t target_bytes = 10 * 1024ull * 1024ull; // default 10 MB
     std::size_t chunk_bytes = 1 * 1024ull * 1024ull;  // default 1 MiB
 
@@ -84,6 +86,12 @@ int main(int argc, char** argv) {
         } else if (std::string_view(argv[i]).rfind("--generate-pgn-size=", 0) == 0) {
             auto val = std::string_view(argv[i]).substr(std::string_view("--generate-pgn-size=").size());
             target_bytes = bayeselo::parse_size_or(val, target_bytes);
+        } else if (std::string_view(argv[i]) == "--keep-moves") {
+            parse_options.keep_moves = true;
+        } else if (std::string_view(argv[i]) == "--io=stream") {
+            use_mmap = false;
+        } else if (std::string_view(argv[i]) == "--io=mmap") {
+            use_mmap = true;
         } else if (std::string_view(argv[i]).rfind("--chunk-size=", 0) == 0) {
             auto val = std::string_view(argv[i]).substr(std::string_view("--chunk-size=").size());
             chunk_bytes = bayeselo::parse_size_or(val, chunk_bytes);
@@ -106,14 +114,16 @@ int main(int argc, char** argv) {
 
     const auto start = std::chrono::steady_clock::now();
     auto chunks = bayeselo::split_pgn_file(tmp, chunk_bytes);
+    auto mapping = use_mmap ? bayeselo::MappedFile::open(tmp) : nullptr;
     std::size_t games = 0;
     for (const auto& c : chunks) {
-        auto parsed = bayeselo::parse_pgn_chunk(c.file, c.start_offset, c.end_offset);
+        auto parsed = mapping ? bayeselo::parse_pgn_chunk_views(mapping, c.start_offset, c.end_offset, parse_options)
+                              : bayeselo::parse_pgn_chunk_views(c.file, c.start_offset, c.end_offset, parse_options);
         if (!parsed) {
             std::cerr << "failed to parse chunk " << c.file << "\n";
             continue;
         }
-        games += parsed->size();
+        games += parsed->games.size();
     }
     const auto end = std::chrono::steady_clock::now();
     const std::chrono::duration<double> elapsed = end - start;
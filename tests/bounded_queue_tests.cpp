@@ -0,0 +1,83 @@
+#include "util/bounded_queue.h"
+#include "util/buffer_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+
+    {
+        bayeselo::BoundedQueue<std::unique_ptr<int>> queue(3);
+        if (queue.capacity() != 4) return fail("capacity should round up to a power of two");
+        for (int i = 0; i < 4; ++i) {
+            auto value = std::make_unique<int>(i);
+            if (!queue.try_push(value) || value) return fail("push into a queue with room failed");
+        }
+        auto extra = std::make_unique<int>(9);
+        if (queue.try_push(extra) || !extra) return fail("push into a full queue should fail and keep the value");
+        for (int i = 0; i < 4; ++i) {
+            std::unique_ptr<int> out;
+            if (!queue.try_pop(out) || !out || *out != i) return fail("queue is not FIFO");
+        }
+        std::unique_ptr<int> none;
+        if (queue.try_pop(none)) return fail("pop from an empty queue should fail");
+    }
+
+    // Several producers and consumers through a small queue: every value arrives exactly once.
+    {
+        constexpr int kProducers = 4;
+        constexpr int kPerProducer = 20000;
+        bayeselo::BoundedQueue<std::uint64_t> queue(8);
+        std::atomic<std::uint64_t> sum{0};
+        std::atomic_int received{0};
+        {
+            std::vector<std::jthread> threads;
+            for (int p = 0; p < kProducers; ++p) {
+                threads.emplace_back([&, p]() {
+                    for (int i = 1; i <= kPerProducer; ++i) queue.push(static_cast<std::uint64_t>(p) * kPerProducer + i);
+                });
+            }
+            for (int c = 0; c < 3; ++c) {
+                threads.emplace_back([&]() {
+                    while (received.fetch_add(1) < kProducers * kPerProducer) sum += queue.pop();
+                });
+            }
+        }
+        const std::uint64_t n = kProducers * kPerProducer;
+        if (sum != n * (n + 1) / 2) return fail("MPMC queue lost or duplicated values");
+    }
+
+    // BufferPool: acquire blocks until a buffer comes back, and returned buffers keep their capacity.
+    {
+        bayeselo::BufferPool pool(2);
+        auto a = pool.acquire();
+        auto b = pool.acquire();
+        a.resize(4096);
+        std::atomic_bool got{false};
+        std::jthread waiter([&]() {
+            auto c = pool.acquire();
+            got = true;
+            if (c.capacity() < 4096 || !c.empty()) std::cerr << "recycled buffer lost its capacity or contents were kept\n";
+            pool.release(std::move(c));
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        if (got) return fail("acquire should block while every buffer is in use");
+        pool.release(std::move(a));
+        waiter.join();
+        if (!got) return fail("acquire did not resume after a release");
+        pool.release(std::move(b));
+    }
+
+    std::cout << "bounded queue tests passed\n";
+    return 0;
+}
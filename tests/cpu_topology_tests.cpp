@@ -0,0 +1,60 @@
+#include "util/cpu_topology.h"
+#include "util/thread_pool.h"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+int main() {
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+
+    const auto list = bayeselo::parse_cpu_list("0-3,8,10-11\n");
+    if (!list || *list != std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11}) return fail("cpu list with ranges parsed wrongly");
+    if (!bayeselo::parse_cpu_list("") || !bayeselo::parse_cpu_list("")->empty()) return fail("empty cpu list should parse as no CPUs");
+    if (bayeselo::parse_cpu_list("3-1") || bayeselo::parse_cpu_list("1,,2") || bayeselo::parse_cpu_list("x")) return fail("malformed cpu list accepted");
+
+    const auto topology = bayeselo::detect_cpu_topology();
+    if (topology.nodes.empty() || topology.cpu_count() == 0) return fail("topology should have at least one CPU");
+    for (const auto& node : topology.nodes) {
+        if (node.empty()) return fail("topology lists an empty node");
+    }
+#ifdef __linux__
+    // Pinnable ids must be ones the process may actually run on (e.g. 4-7 in a cpuset container).
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (::sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        if (!topology.from_affinity) return fail("topology should come from the affinity mask");
+        for (const auto& node : topology.nodes) {
+            for (const unsigned cpu : node) {
+                if (!CPU_ISSET(cpu, &allowed)) return fail("topology lists CPU " + std::to_string(cpu) + " outside the affinity mask");
+            }
+        }
+    }
+#endif
+
+    // Pinned or not, a pool runs everything and reports nodes within range; more workers than CPUs wrap.
+    for (bool pin : {false, true}) {
+        bayeselo::ThreadPool pool(topology.cpu_count() + 1, pin);
+        if (pool.node_count() == 0 || pool.node_count() > topology.nodes.size()) return fail("pool node count out of range");
+        if (pool.current_node() != 0) return fail("threads outside the pool should report node 0");
+        std::atomic_size_t ran{0};
+        std::atomic_bool bad_node{false};
+        pool.enqueue_range(0, 200, 1, [&](std::size_t) {
+            if (pool.current_node() >= pool.node_count()) bad_node = true;
+            ++ran;
+        });
+        pool.wait_for_completion();
+        if (ran != 200 || bad_node) return fail(std::string("pool with pin=") + (pin ? "true" : "false") + " misbehaved");
+    }
+
+    std::cout << "cpu topology tests passed\n";
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "util/directory_walker.h"
+#include "util/thread_pool.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+int main() {
+    auto fail = [&](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "bayeselo_walker_test";
+    struct Cleanup {
+        std::filesystem::path root;
+        ~Cleanup() {
+            std::error_code ec;
+            std::filesystem::remove_all(root, ec);
+        }
+    } cleanup{root};
+    std::filesystem::remove_all(root);
+
+    std::vector<std::string> expected;
+    for (int a = 0; a < 4; ++a) {
+        for (int b = 0; b < 3; ++b) {
+            const auto dir = root / ("d" + std::to_string(a)) / ("e" + std::to_string(b));
+            std::filesystem::create_directories(dir);
+            for (int f = 0; f < 5; ++f) {
+                const auto file = dir / ("g" + std::to_string(f) + ".pgn");
+                std::ofstream(file) << "[Event \"x\"]\n";
+                expected.push_back(file.string());
+            }
+        }
+    }
+    std::filesystem::create_directories(root / "empty" / "deeper");
+    std::ofstream(root / "top.pgn") << "\n";
+    expected.push_back((root / "top.pgn").string());
+    std::sort(expected.begin(), expected.end());
+
+    for (std::size_t threads : {1u, 4u}) {
+        bayeselo::ThreadPool pool(threads);
+        std::mutex mutex;
+        std::vector<std::string> found;
+        std::size_t errors = 0;
+        bayeselo::DirectoryWalker walker(pool, [&](const std::filesystem::path&, const std::error_code&) { ++errors; });
+        walker.walk(root, [&](const std::filesystem::directory_entry& entry) {
+            std::scoped_lock lock(mutex);
+            found.push_back(entry.path().string());
+        });
+        walker.wait();
+        std::sort(found.begin(), found.end());
+        if (found != expected) return fail("walker with " + std::to_string(threads) + " threads found " + std::to_string(found.size()) + " files, expected " + std::to_string(expected.size()));
+
+        walker.walk(root / "missing", [](const std::filesystem::directory_entry&) {});
+        walker.wait();
+        if (errors != 1) return fail("missing directory should be reported once");
+    }
+
+    std::cout << "directory walker tests passed\n";
+    return 0;
+}
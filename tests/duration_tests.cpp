@@ -1,6 +1,7 @@
 #include "bayeselo/duration.h"
 
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 
 int main() {
@@ -52,6 +53,51 @@ int main() {
         return 1;
     } catch (const std::exception&) {
     }
+
+    // PGN TimeControl values: parsed without exceptions, estimated per side over a game's plies.
+    using bayeselo::parse_time_control;
+    using bayeselo::TimeControlError;
+    auto estimate = [](const char* text, std::uint32_t plies, double expected) -> bool {
+        const auto control = parse_time_control(text);
+        if (!control) {
+            std::cerr << "time control test failed: \"" << text << "\" should parse\n";
+            return false;
+        }
+        const double got = control->estimate_seconds(plies);
+        if (std::abs(got - expected) > 1e-9) {
+            std::cerr << "time control test failed: \"" << text << "\" over " << plies << " plies expected " << expected << " got " << got << "\n";
+            return false;
+        }
+        return true;
+    };
+    if (!estimate("300", 80, 300.0) || !estimate("300+2", 0, 300.0) || !estimate("300+2", 81, 300.0 + 2 * 41)) {
+        return 1;
+    }
+    if (!estimate("3m+2", 10, 190.0) || !estimate("*60", 120, 60.0) || !estimate("0.5+0.1", 4, 0.7)) {
+        return 1;
+    }
+    // 40 moves in 2h, then 1h for the rest; a final period with a move count repeats.
+    if (!estimate("40/7200:3600", 80, 7200.0) || !estimate("40/7200:3600", 82, 10800.0)) {
+        return 1;
+    }
+    if (!estimate("40/5400+30:1800+30", 100, 5400.0 + 1800.0 + 30 * 50) || !estimate("40/7200", 161, 3 * 7200.0)) {
+        return 1;
+    }
+    if (parse_time_control("300")->depends_on_plies() || !parse_time_control("300+2")->depends_on_plies() ||
+        !parse_time_control("40/7200:3600")->depends_on_plies()) {
+        std::cerr << "time control test failed: depends_on_plies\n";
+        return 1;
+    }
+    if (parse_time_control("?").error() != TimeControlError::Unknown || parse_time_control("-").error() != TimeControlError::Unlimited) {
+        std::cerr << "time control test failed: \"?\" and \"-\" should be reported, not parsed\n";
+        return 1;
+    }
+    for (const char* bad : {"", "abc", "5x+3", "-5m", "0/60", "40/", "300+", "*", "1:2:3:4:5", "300+2+2"}) {
+        if (parse_time_control(bad) || parse_time_control(bad).error() != TimeControlError::Malformed) {
+            std::cerr << "time control test failed: \"" << bad << "\" should be malformed\n";
+            return 1;
+        }
+    }
     std::cout << "duration tests passed\n";
     return 0;
 }
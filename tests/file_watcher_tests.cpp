@@ -0,0 +1,94 @@
+#include "util/file_watcher.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+int main() {
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+    using namespace std::chrono_literals;
+
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "bayeselo_watcher_test";
+    struct Cleanup {
+        std::filesystem::path root;
+        ~Cleanup() {
+            std::error_code ec;
+            std::filesystem::remove_all(root, ec);
+        }
+    } cleanup{root};
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    const auto file = root / "games.pgn";
+    std::ofstream(file) << "[Event \"a\"]\n";
+    auto append = [&](const std::string& text) { std::ofstream(file, std::ios::app) << text; };
+
+    bayeselo::FileWatcher watcher;
+    if (watcher.add(root / "missing.pgn")) return fail("a missing file should not be watchable");
+    if (!watcher.add(file)) return fail("cannot watch " + file.string());
+
+    // Append.
+    {
+        std::jthread writer([&]() {
+            std::this_thread::sleep_for(50ms);
+            append("1. e4 *\n");
+        });
+        if (watcher.wait(50ms) != std::vector<std::size_t>{0}) return fail("append was not reported");
+    }
+
+    // Replace by renaming a new file over the path; later appends go to the new file.
+    {
+        std::jthread writer([&]() {
+            std::this_thread::sleep_for(50ms);
+            std::ofstream(root / "next.pgn") << "[Event \"b\"]\n";
+            std::filesystem::rename(root / "next.pgn", file);
+        });
+        if (watcher.wait(50ms) != std::vector<std::size_t>{0}) return fail("replacement by rename was not reported");
+    }
+    {
+        std::jthread writer([&]() {
+            std::this_thread::sleep_for(50ms);
+            append("1. d4 *\n");
+        });
+        if (watcher.wait(50ms) != std::vector<std::size_t>{0}) return fail("append to the replacement was not reported");
+    }
+
+    // Delete and create again.
+    {
+        std::jthread writer([&]() {
+            std::this_thread::sleep_for(50ms);
+            std::filesystem::remove(file);
+            std::this_thread::sleep_for(20ms);
+            std::ofstream(file) << "[Event \"c\"]\n";
+        });
+        if (watcher.wait(100ms) != std::vector<std::size_t>{0}) return fail("delete and recreate was not reported");
+    }
+
+    // A writer appending faster than the settle interval must not hold the batch open forever.
+    {
+        std::atomic_bool stop{false};
+        std::jthread writer([&]() {
+            while (!stop) {
+                append("1. c4 *\n");
+                std::this_thread::sleep_for(10ms);
+            }
+        });
+        const auto start = std::chrono::steady_clock::now();
+        const auto changed = watcher.wait(50ms);
+        const auto took = std::chrono::steady_clock::now() - start;
+        stop = true;
+        if (changed != std::vector<std::size_t>{0}) return fail("continuous appends were not reported");
+        if (took > 50ms * bayeselo::FileWatcher::kMaxBatchSettles + 500ms) return fail("batch did not close while appends continued");
+    }
+
+    std::cout << "file watcher tests passed\n";
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "parser/chunk_splitter.h"
+#include "parser/game_cache.h"
+#include "parser/pgn_parser.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+bool same_game(const bayeselo::GameView& a, const bayeselo::GameView& b) {
+    return a.white == b.white && a.black == b.black && a.utc_date == b.utc_date && a.utc_time == b.utc_time &&
+           a.time_control == b.time_control && a.termination == b.termination && a.outcome == b.outcome &&
+           a.ply_count == b.ply_count && a.estimated_duration_seconds == b.estimated_duration_seconds;
+}
+
+} // namespace
+
+int main() {
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "bayeselo_cache_test";
+    struct Cleanup {
+        std::filesystem::path dir;
+        ~Cleanup() {
+            std::error_code ec;
+            std::filesystem::remove_all(dir, ec);
+        }
+    } cleanup{dir};
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    const auto pgn = dir / "games.pgn";
+    {
+        std::ofstream out(pgn, std::ios::binary);
+        for (int i = 0; i < 40; ++i) {
+            out << "[Event \"Cache\"]\n[White \"Engine" << i % 3 << "\"]\n[Black \"Engine" << (i + 1) % 3 << "\"]\n"
+                << "[Result \"" << (i % 4 == 0 ? "1-0" : i % 4 == 1 ? "0-1" : i % 4 == 2 ? "1/2-1/2" : "*") << "\"]\n";
+            if (i % 2 == 0) {
+                out << "[TimeControl \"" << 60 + i << "\"]\n[Termination \"adjudication\"]\n[UTCDate \"2024.01.0" << i % 9 + 1 << "\"]\n";
+            }
+            out << "\n1. e4 e5 2. Nf3 " << (i % 5 == 0 ? "Nc6 " : "") << "*\n\n";
+        }
+    }
+    const auto whole = bayeselo::parse_pgn_chunk_views(pgn, 0, std::filesystem::file_size(pgn));
+    if (!whole || whole->games.size() != 40) return fail("expected 40 games in the source");
+
+    auto key = bayeselo::game_cache_key(pgn);
+    if (!key) return fail("game_cache_key failed");
+    const auto cache_file = bayeselo::game_cache_path(dir / "cache", *key);
+    std::filesystem::create_directories(cache_file.parent_path());
+    if (bayeselo::game_cache_matches(cache_file, *key) || bayeselo::load_game_cache(cache_file, *key)) return fail("missing cache should not load");
+
+    // Chunks are added out of order; the cache still holds the games in file order.
+    const auto ranges = bayeselo::split_pgn_file(pgn, 300);
+    {
+        bayeselo::GameCacheWriter writer(cache_file, *key, ranges.size());
+        for (std::size_t i = ranges.size(); i-- > 0;) {
+            auto chunk = bayeselo::parse_pgn_chunk_views(pgn, ranges[i].start_offset, ranges[i].end_offset);
+            if (!chunk || !writer.add(i, *chunk)) return fail("writing the cache failed");
+        }
+    }
+    if (!bayeselo::game_cache_matches(cache_file, *key)) return fail("written cache should match its key");
+    auto cached = bayeselo::load_game_cache(cache_file, *key);
+    if (!cached || cached->games.size() != whole->games.size()) return fail("cache did not load all games");
+    for (std::size_t i = 0; i < whole->games.size(); ++i) {
+        if (!same_game(cached->games[i], whole->games[i])) return fail("cached game " + std::to_string(i) + " differs from the parsed one");
+    }
+
+    // A changed source (here: a different mtime) invalidates the cache.
+    auto stale = *key;
+    stale.mtime += 1;
+    if (bayeselo::game_cache_matches(cache_file, stale) || bayeselo::load_game_cache(cache_file, stale)) return fail("stale cache should not load");
+
+    // A truncated cache is rejected even though its header still matches.
+    std::filesystem::resize_file(cache_file, std::filesystem::file_size(cache_file) - 3);
+    if (bayeselo::load_game_cache(cache_file, *key)) return fail("truncated cache should not load");
+
+    // An abandoned chunk means no cache is written.
+    std::filesystem::remove(cache_file);
+    {
+        bayeselo::GameCacheWriter writer(cache_file, *key, 2);
+        writer.add(0, *whole);
+        writer.abandon(1);
+    }
+    if (std::filesystem::exists(cache_file)) return fail("abandoned cache should not be written");
+
+    std::cout << "game cache tests passed\n";
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "parser/chunk_splitter.h"
+#include "parser/game_index.h"
+#include "parser/pgn_parser.h"
+#include "util/mapped_file.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+int main() {
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "bayeselo_index_test";
+    struct Cleanup {
+        std::filesystem::path dir;
+        ~Cleanup() {
+            std::error_code ec;
+            std::filesystem::remove_all(dir, ec);
+        }
+    } cleanup{dir};
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // Leading blank lines, then games of very different lengths; expected offsets are recorded while writing.
+    const auto pgn = dir / "games.pgn";
+    std::vector<std::uint64_t> expected{0};
+    std::string text = "\n\n";
+    for (int i = 0; i < 25; ++i) {
+        if (i > 0) expected.push_back(text.size());
+        text += "[Event \"Index\"]\n[White \"P" + std::to_string(i) + "\"]\n[Black \"Q\"]\n[Result \"1-0\"]\n\n1. e4 ";
+        text += std::string(static_cast<std::size_t>(i % 4) * 40, ' ') + "{" + std::string(static_cast<std::size_t>(i % 3) * 50, 'c') + "} e5 1-0\n\n";
+    }
+    std::ofstream(pgn, std::ios::binary) << text;
+
+    const auto mapping = bayeselo::MappedFile::open(pgn);
+    auto key = bayeselo::game_cache_key(pgn);
+    if (!mapping || !key) return fail("setup failed");
+    const auto index_file = bayeselo::game_index_path(pgn);
+    if (index_file.filename() != "games.pgn.pgnidx") return fail("unexpected sidecar name " + index_file.string());
+    if (bayeselo::load_game_index(index_file, *key)) return fail("missing index should not load");
+
+    const auto ranges = bayeselo::split_pgn_range(pgn, mapping->size(), 97);
+    {
+        bayeselo::GameIndexWriter writer(index_file, *key, ranges.size());
+        for (std::size_t i = ranges.size(); i-- > 0;) {
+            if (!writer.add(i, bayeselo::find_game_starts(mapping->view(), ranges[i].start_offset, ranges[i].end_offset))) return fail("writing the index failed");
+        }
+    }
+    auto index = bayeselo::load_game_index(index_file, *key);
+    if (!index) return fail("index did not load");
+    if (index->offsets != expected) return fail("index offsets differ from the game starts");
+
+    // O(1) access to game n.
+    const auto [begin, end] = index->game_span(7);
+    const auto seventh = bayeselo::parse_pgn_views(mapping->view().substr(begin, end - begin));
+    if (seventh.games.size() != 1 || seventh.games[0].white != "P7") return fail("game_span(7) should hold exactly game 7");
+
+    // Game-balanced split: every chunk holds 6 or 7 of the 25 games, and all are parsed once.
+    std::size_t total = 0;
+    for (const auto& range : bayeselo::split_pgn_index(pgn, *index, 4)) {
+        auto chunk = bayeselo::parse_pgn_chunk_views(mapping, range.start_offset, range.end_offset);
+        if (!chunk || chunk->games.size() < 6 || chunk->games.size() > 7) return fail("indexed chunk is not game-balanced");
+        total += chunk->games.size();
+    }
+    if (total != 25) return fail("indexed chunks parsed " + std::to_string(total) + " games, expected 25");
+
+    auto stale = *key;
+    stale.size += 1;
+    if (bayeselo::load_game_index(index_file, stale)) return fail("stale index should not load");
+    std::filesystem::resize_file(index_file, std::filesystem::file_size(index_file) - 8);
+    if (bayeselo::load_game_index(index_file, *key)) return fail("truncated index should not load");
+
+    std::cout << "game index tests passed\n";
+    return 0;
+}
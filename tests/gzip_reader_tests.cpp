@@ -0,0 +1,190 @@
+#include "parser/gzip_reader.h"
+#include "util/mapped_file.h"
+#include "util/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef BAYESELO_HAVE_ZLIB
+#include <zlib.h>
+
+namespace {
+
+// Raw-deflates text into a BGZF member: gzip header with a "BC" extra subfield carrying the member size.
+std::string bgzf_member(const std::string& text) {
+    z_stream zs{};
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::string body(deflateBound(&zs, static_cast<uLong>(text.size())), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    zs.avail_in = static_cast<uInt>(text.size());
+    zs.next_out = reinterpret_cast<Bytef*>(body.data());
+    zs.avail_out = static_cast<uInt>(body.size());
+    deflate(&zs, Z_FINISH);
+    body.resize(body.size() - zs.avail_out);
+    deflateEnd(&zs);
+
+    auto put16 = [](std::string& out, std::uint32_t v) {
+        out.push_back(static_cast<char>(v & 0xff));
+        out.push_back(static_cast<char>((v >> 8) & 0xff));
+    };
+    std::string member = {'\x1f', '\x8b', '\x08', '\x04', 0, 0, 0, 0, 0, '\xff'};
+    put16(member, 6);
+    member += "BC";
+    put16(member, 2);
+    put16(member, static_cast<std::uint32_t>(body.size() + 25));
+    member += body;
+    const auto crc = static_cast<std::uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(text.data()), static_cast<uInt>(text.size())));
+    put16(member, crc & 0xffff);
+    put16(member, crc >> 16);
+    put16(member, static_cast<std::uint32_t>(text.size()) & 0xffff);
+    put16(member, static_cast<std::uint32_t>(text.size()) >> 16);
+    return member;
+}
+
+} // namespace
+
+int main() {
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+    std::string text;
+    std::vector<std::pair<std::size_t, std::size_t>> game_spans; // [begin, end) of each game in text
+    for (int i = 0; i < 50; ++i) {
+        const std::size_t begin = text.size();
+        text += "[Event \"Z\"]\n[White \"A" + std::to_string(i) + "\"]\n[Black \"B\"]\n[Result \"1-0\"]\n\n1. e4 e5 2. Nf3 Nc6 1-0\n\n";
+        game_spans.emplace_back(begin, text.size());
+    }
+
+    // Split at awkward offsets so games straddle member and group boundaries.
+    std::string compressed;
+    for (std::size_t pos = 0; pos < text.size(); pos += 97) {
+        compressed += bgzf_member(text.substr(pos, 97));
+    }
+    compressed += bgzf_member(""); // BGZF end-of-file marker
+
+    auto members = bayeselo::scan_bgzf_members(compressed);
+    if (members.size() != (text.size() + 96) / 97 + 1) return fail("unexpected BGZF member count: " + std::to_string(members.size()));
+    if (!bayeselo::scan_bgzf_members(text).empty()) return fail("plain text detected as BGZF");
+
+    std::vector<char> inflated;
+    if (!bayeselo::inflate_gzip(compressed, inflated) || std::string(inflated.begin(), inflated.end()) != text) return fail("multi-member inflate mismatch");
+    std::vector<char> broken;
+    if (bayeselo::inflate_gzip(compressed.substr(0, compressed.size() / 2), broken)) return fail("truncated input should fail to inflate");
+
+    std::istringstream source(compressed);
+    bayeselo::GzipStreambuf buf(source);
+    std::istream in(&buf);
+    std::string streamed((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (streamed != text) return fail("GzipStreambuf output mismatch");
+
+    const std::filesystem::path path = "temp_gzip_test.pgn.gz";
+    struct TempFileGuard {
+        std::filesystem::path path;
+        ~TempFileGuard() {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    } guard{path};
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << compressed;
+    }
+    auto mapping = bayeselo::MappedFile::open(path);
+    if (!mapping || !bayeselo::is_gzip_file(path)) return fail("failed to open compressed test file");
+    std::atomic_size_t games{0};
+    std::atomic_size_t plies{0};
+    std::mutex pieces_mutex;
+    std::vector<std::pair<std::size_t, std::vector<std::string>>> pieces;
+    {
+        bayeselo::ThreadPool pool(4);
+        bayeselo::enqueue_bgzf_file(
+            pool, mapping, bayeselo::scan_bgzf_members(mapping->view()), 300, bayeselo::ParseOptions{false},
+            [&](const bayeselo::ParsedChunk& chunk, std::size_t order) {
+                games += chunk.games.size();
+                std::vector<std::string> whites;
+                for (const auto& g : chunk.games) {
+                    plies += g.ply_count;
+                    whites.emplace_back(g.white);
+                }
+                std::scoped_lock lock(pieces_mutex);
+                pieces.emplace_back(order, std::move(whites));
+            },
+            [](std::string_view error) { std::cerr << error << "\n"; });
+        pool.wait_for_completion();
+    }
+    if (games != 50 || plies != 200) return fail("parallel BGZF parse: expected 50 games/200 plies, got " + std::to_string(games) + "/" + std::to_string(plies));
+
+    std::sort(pieces.begin(), pieces.end());
+    std::vector<std::string> ordered;
+    for (auto& [order, whites] : pieces) ordered.insert(ordered.end(), whites.begin(), whites.end());
+    for (std::size_t i = 0; i < ordered.size(); ++i) {
+        if (ordered[i] != "A" + std::to_string(i)) return fail("BGZF pieces sorted by order do not follow the file at game " + std::to_string(i));
+    }
+
+    // A member that fails to inflate loses its whole group; no game may be stitched across the gap.
+    // With 97-byte members and 300-byte groups each group holds 4 members, so member 9 is in group 2.
+    {
+        std::string corrupt = compressed;
+        const auto corrupt_members = bayeselo::scan_bgzf_members(corrupt);
+        corrupt[corrupt_members[9].offset + 18] = '\xff'; // first deflate byte: invalid block type
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << corrupt;
+        }
+        auto damaged = bayeselo::MappedFile::open(path);
+        if (!damaged) return fail("failed to open corrupted test file");
+        const std::size_t lost_begin = 8 * 97;
+        const std::size_t lost_end = 12 * 97;
+        std::mutex whites_mutex;
+        std::vector<std::string> whites;
+        std::atomic_size_t errors{0};
+        std::atomic_bool short_game{false};
+        {
+            bayeselo::ThreadPool pool(4);
+            bayeselo::enqueue_bgzf_file(
+                pool, damaged, bayeselo::scan_bgzf_members(damaged->view()), 300, bayeselo::ParseOptions{false},
+                [&](const bayeselo::ParsedChunk& chunk, std::size_t) {
+                    std::scoped_lock lock(whites_mutex);
+                    for (const auto& g : chunk.games) {
+                        if (g.ply_count != 4) short_game = true;
+                        whites.emplace_back(g.white);
+                    }
+                },
+                [&](std::string_view) { ++errors; });
+            pool.wait_for_completion();
+        }
+        if (errors != 1) return fail("corrupt BGZF member should be reported once, got " + std::to_string(errors.load()));
+        if (short_game) return fail("a game around the corrupt BGZF member lost plies");
+        std::size_t intact = 0;
+        for (std::size_t i = 0; i < game_spans.size(); ++i) {
+            const bool overlaps = game_spans[i].first < lost_end && game_spans[i].second > lost_begin;
+            const bool parsed = std::find(whites.begin(), whites.end(), "A" + std::to_string(i)) != whites.end();
+            if (overlaps && parsed) return fail("game " + std::to_string(i) + " was stitched across the corrupt BGZF group");
+            intact += overlaps ? 0 : 1;
+        }
+        if (whites.size() != intact) return fail("corrupt BGZF group: expected " + std::to_string(intact) + " games, got " + std::to_string(whites.size()));
+    }
+
+    std::cout << "gzip reader tests passed\n";
+    return 0;
+}
+
+#else
+
+int main() {
+    std::cout << "gzip reader tests skipped (built without zlib)\n";
+    return 0;
+}
+
+#endif
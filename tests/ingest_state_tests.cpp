@@ -0,0 +1,52 @@
+#include "rating/ingest_state.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+
+int main() {
+    using bayeselo::complete_games_end;
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+
+    // Only finished games are consumed; a game still being appended is left for the next run.
+    const std::string one = "[Event \"A\"]\n[Result \"1-0\"]\n\n1. e4 e5 1-0\n\n";
+    const std::string two = "[Event \"B\"]\n[Result \"*\"]\n\n1. d4 {draw offered} *\n";
+    if (complete_games_end(one) != one.size()) return fail("a finished game should be complete");
+    if (complete_games_end(one + two) != one.size() + two.size()) return fail("two finished games should be complete");
+    if (complete_games_end(one + "[Event \"B\"]\n[White \"X\"]\n") != one.size()) return fail("a game with only tags is not complete");
+    if (complete_games_end(one + "[Event \"B\"]\n\n1. d4 d5 2. c4") != one.size()) return fail("movetext without a result is not complete");
+    if (complete_games_end(one + "[Event \"B\"]\n\n1. d4 d5 1-0") != one.size()) return fail("a result without its newline is not complete");
+    const std::string draw = "[Event \"B\"]\n\n1. d4 d5 1/2-1/2\n";
+    if (complete_games_end(one + draw) != one.size() + draw.size()) return fail("a draw with a newline is complete");
+    if (complete_games_end("\n\n") != 2) return fail("whitespace only should be consumed");
+
+    // Round trip, and prefix hashes notice a rewritten file.
+    bayeselo::IngestState state;
+    bayeselo::FilterConfig filters;
+    filters.min_plies = 10;
+    state.filter_fingerprint = bayeselo::filter_fingerprint(filters);
+    state.players = {"Alpha", "Beta"};
+    state.files.push_back({"/tmp/a.pgn", 1234, bayeselo::file_head_hash(one, 20), {{0, 1, 1.0}, {1, 0, 0.5}, {0, 1, 0.0}}});
+    const auto path = std::filesystem::temp_directory_path() / "bayeselo_ingest_state_test.bin";
+    if (!bayeselo::save_ingest_state(path, state)) return fail("saving the state failed");
+    auto loaded = bayeselo::load_ingest_state(path);
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    if (!loaded) return fail("state did not load");
+    if (loaded->players != state.players || loaded->files.size() != 1 || loaded->files[0].offset != 1234 ||
+        loaded->files[0].pairings.size() != 3 || loaded->files[0].pairings[1].score != 0.5 || loaded->files[0].pairings[2].score != 0.0) {
+        return fail("state changed in the round trip");
+    }
+    if (loaded->filter_fingerprint != bayeselo::filter_fingerprint(filters)) return fail("fingerprint changed in the round trip");
+    filters.min_plies = 11;
+    if (loaded->filter_fingerprint == bayeselo::filter_fingerprint(filters)) return fail("different filters should change the fingerprint");
+    if (bayeselo::file_head_hash(one, 20) == bayeselo::file_head_hash(two, 20)) return fail("different prefixes should hash differently");
+    if (bayeselo::file_head_hash(one, 20) != bayeselo::file_head_hash(one + two, 20)) return fail("appending should keep the prefix hash");
+
+    std::cout << "ingest state tests passed\n";
+    return 0;
+}
@@ -45,6 +45,7 @@ int main() {
     if (!games_opt) return fail("parse_pgn_chunk returned nullopt");
     auto games = std::move(*games_opt);
     bayeselo::FilterConfig cfg;
+    const bayeselo::FilterProgram program(cfg);
 
     std::atomic_size_t accepted{0};
     std::vector<bayeselo::Game> kept;
@@ -53,7 +54,7 @@ int main() {
         g.moves.clear();
         g.moves.shrink_to_fit();
         if (!g.moves.empty()) return fail("expected moves cleared");
-        if (!bayeselo::passes_filters(g, cfg)) continue;
+        if (!bayeselo::passes_filters(g, program)) continue;
         if (accepted.load() >= 1) break; // simulate --max-games=1
         kept.push_back(std::move(g));
         accepted.fetch_add(1);
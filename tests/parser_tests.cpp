@@ -1,13 +1,21 @@
 #include "parser/pgn_parser.h"
 #include "parser/chunk_splitter.h"
+#include "parser/line_scanner.h"
+#include "parser/stream_reader.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <optional>
+#include <random>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <system_error>
+#include <vector>
 
 int main() {
     const std::string path = "temp_test.pgn";
@@ -52,15 +60,33 @@ int main() {
     if (game.meta.white != "Alice") return fail("expected white Alice, got " + game.meta.white);
     if (game.meta.black != "Bob") return fail("expected black Bob, got " + game.meta.black);
     if (game.result.outcome != bayeselo::GameResult::Outcome::WhiteWin) return fail("outcome not parsed as WhiteWin");
-    if (game.ply_count < 6) return fail("ply count too low: " + std::to_string(game.ply_count));
+    if (game.ply_count != 6) return fail("expected 6 plies, got " + std::to_string(game.ply_count));
+    if (game.moves.size() != 6 || game.moves.front() != "e4" || game.moves.back() != "a6") return fail("moves should hold only SAN tokens");
     if (!game.estimated_duration_seconds) return fail("missing estimated duration");
-    if (std::abs(*game.estimated_duration_seconds - 300.0) > 1e-3) return fail("expected 300s estimate, got " + std::to_string(*game.estimated_duration_seconds));
+    // 5m+3 over 6 plies: 300s base plus 3s for each of the side's 3 moves.
+    if (std::abs(*game.estimated_duration_seconds - 309.0) > 1e-3) return fail("expected 309s estimate, got " + std::to_string(*game.estimated_duration_seconds));
+    auto mapping = bayeselo::MappedFile::open(path);
+    if (!mapping) return fail("MappedFile::open failed");
+    if (mapping->size() != content.size()) return fail("mapped size mismatch");
+    auto mapped_games = bayeselo::parse_pgn_chunk(*mapping, 0, mapping->size());
+    if (!mapped_games || mapped_games->size() != 1) return fail("mmap backend should parse 1 game");
+    if ((*mapped_games)[0].meta.white != "Alice" || (*mapped_games)[0].ply_count != game.ply_count) return fail("mmap backend disagrees with stream backend");
+    for (bool use_mapping : {true, false}) {
+        auto chunk = use_mapping ? bayeselo::parse_pgn_chunk_views(mapping, 0, content.size())
+                                 : bayeselo::parse_pgn_chunk_views(path, 0, content.size());
+        if (!chunk || chunk->games.size() != 1) return fail("view parser should return 1 game");
+        auto moved = std::move(*chunk); // views must survive moving the chunk that owns their bytes
+        const auto& view = moved.games[0];
+        if (view.white != "Alice" || view.black != "Bob" || !view.termination || *view.termination != "Normal") return fail("view parser tag mismatch");
+        if (bayeselo::to_game(moved, 0).moves.size() != 6) return fail("to_game should carry the kept moves");
+    }
     bayeselo::FilterConfig config;
     config.termination = "normal";
-    if (!bayeselo::passes_filters(game, config)) return fail("termination filter rejected valid game");
+    const bayeselo::FilterProgram termination_program(config);
+    if (!bayeselo::passes_filters(game, termination_program)) return fail("termination filter rejected valid game");
     auto filtered = game;
     filtered.result.termination = std::nullopt;
-    if (bayeselo::passes_filters(filtered, config)) return fail("termination filter accepted missing termination");
+    if (bayeselo::passes_filters(filtered, termination_program)) return fail("termination filter accepted missing termination");
 
     // Chunk splitter should clamp to EOF even without trailing Event
     const std::string single_game = R"([Event "Solo"]
@@ -82,6 +108,200 @@ int main() {
     }
     if (chunks.empty()) return fail("chunk splitter produced no chunks");
     if (chunks.back().end_offset != size) return fail("chunk end offset mismatch: expected " + std::to_string(size) + ", got " + std::to_string(chunks.back().end_offset));
+
+    // Ply counting skips move numbers, comments, variations, NAGs and the result; headers-only mode allocates no moves.
+    const std::string annotated = R"([Event "Annotated"]
+[White "W"]
+[Black "B"]
+[Result "0-1"]
+
+1. Nf3 d5 2. g3 {a comment
+spanning lines} 2... c5 (2...Nf6 3. Bg2 (3. c4)) 3. Bg2 $1 Nc6 ; rest of line e4 e5
+4. O-O 0-0-0 0-1
+)";
+    auto annotated_games = bayeselo::parse_pgn_text(annotated);
+    if (annotated_games.size() != 1) return fail("expected 1 annotated game");
+    if (annotated_games[0].ply_count != 8) return fail("annotated game: expected 8 plies, got " + std::to_string(annotated_games[0].ply_count));
+    auto counted_only = bayeselo::parse_pgn_text(annotated, bayeselo::ParseOptions{false});
+    if (counted_only.size() != 1 || counted_only[0].ply_count != 8) return fail("counting mode disagrees with keep-moves mode");
+    if (!counted_only[0].moves.empty() || counted_only[0].moves.capacity() != 0) return fail("counting mode should not allocate moves");
+
+    // Move numbers written against the move ("1.e4", "2...Nc6") are stripped from kept moves.
+    {
+        const auto compact = bayeselo::parse_pgn_text("[White \"W\"]\n[Black \"B\"]\n\n1.e4 e5 2.Nf3 2...Nc6 3.O-O *\n");
+        const std::vector<std::string_view> expected{"e4", "e5", "Nf3", "Nc6", "O-O"};
+        if (compact.size() != 1 || !std::equal(compact[0].moves.begin(), compact[0].moves.end(), expected.begin(), expected.end())) {
+            return fail("move-number prefixes should be stripped from kept moves");
+        }
+    }
+
+    // Kept moves are packed per chunk; each game's span sees only its own tokens.
+    {
+        auto packed = bayeselo::parse_pgn_views(annotated + "\n" + single_game);
+        if (packed.games.size() != 2 || packed.moves.games() != 2) return fail("packed moves: expected 2 games");
+        const auto first = packed.moves[0];
+        const auto second = packed.moves[1];
+        if (first.size() != 8 || first.front() != "Nf3" || first[4] != "Bg2" || first.back() != "0-0-0") return fail("packed moves: first game tokens wrong");
+        const std::vector<std::string_view> expected{"e4", "e5", "Nf3", "Nc6"};
+        if (!std::equal(second.begin(), second.end(), expected.begin(), expected.end())) return fail("packed moves: second game tokens wrong");
+        const bayeselo::MoveList copy(second);
+        if (copy.size() != 4 || copy.back() != "Nc6" || copy.end() - copy.begin() != 4) return fail("MoveList copy of a span mismatch");
+    }
+
+    // Low-cardinality tags are interned per chunk; ChunkFilter's per-value verdicts match passes_filters.
+    {
+        std::string many;
+        for (int i = 0; i < 40; ++i) {
+            many += "[White \"W\"]\n[Black \"B\"]\n[Result \"1-0\"]\n[TimeControl \"" + std::to_string(60 + (i % 20) * 30) + "+1\"]\n";
+            if (i % 3 != 0) many += std::string("[Termination \"") + (i % 3 == 1 ? "Normal" : "Time forfeit") + "\"]\n";
+            many += "\n1. e4 e5 1-0\n\n";
+        }
+        auto chunk = bayeselo::parse_pgn_views(many);
+        if (chunk.games.size() != 40) return fail("dictionary test: expected 40 games");
+        if (chunk.time_controls.size() != 20 || chunk.time_control_specs.size() != 20) return fail("expected 20 distinct time controls");
+        if (chunk.terminations.size() != 2) return fail("expected 2 distinct terminations");
+        if (chunk.players.size() != 2) return fail("expected 2 distinct players");
+        for (const auto& g : chunk.games) {
+            if (chunk.players[g.white_id] != g.white || chunk.players[g.black_id] != g.black) return fail("player id points at the wrong name");
+            if (chunk.time_controls[g.time_control_id] != *g.time_control) return fail("time control id points at the wrong value");
+            if (g.termination ? chunk.terminations[g.termination_id] != *g.termination : g.termination_id != bayeselo::kNoTagId) return fail("termination id mismatch");
+        }
+        bayeselo::FilterConfig tag_filters;
+        tag_filters.min_time_seconds = 200;
+        tag_filters.termination = "forfeit";
+        const bayeselo::FilterProgram program(tag_filters);
+        bayeselo::ChunkFilter filter(chunk, program);
+        std::size_t passed = 0;
+        for (std::size_t i = 0; i < chunk.games.size(); ++i) {
+            if (filter.passes(i) != bayeselo::passes_filters(chunk.games[i], program)) return fail("ChunkFilter disagrees with passes_filters");
+            passed += filter.passes(i) ? 1 : 0;
+        }
+        if (passed == 0 || passed == chunk.games.size()) return fail("tag filters should keep some games and drop others");
+    }
+
+    // With a filter program the parser drops games rejected by their tags without scanning their
+    // movetext, keeping exactly the games full filtering keeps.
+    {
+        std::string mixed;
+        for (int i = 0; i < 12; ++i) {
+            const bool stockfish = i % 4 == 0;
+            mixed += std::string("[White \"") + (stockfish ? "Stockfish 16" : "Leela") + "\"]\n[Black \"Other\"]\n[Result \"" + (i % 3 == 0 ? "1-0" : "0-1") + "\"]\n[TimeControl \"60+1\"]\n\n";
+            // A wrapped comment with a line that looks like a tag must not split a skipped game.
+            mixed += "1. e4 {long\n[%clk 0:01:00] comment} e5 2. Nf3 Nc6\n3. Bb5 a6 " + std::string(i % 3 == 0 ? "1-0" : "0-1") + "\n\n";
+        }
+        bayeselo::FilterConfig early;
+        early.either_name = "STOCKFISH";
+        early.min_plies = 4;
+        early.max_time_seconds = 64;
+        const bayeselo::FilterProgram program(early);
+        auto all = bayeselo::parse_pgn_views(mixed);
+        if (all.games.size() != 12) return fail("early rejection test: expected 12 games without a filter");
+        bayeselo::ParseOptions filtered_options;
+        filtered_options.filter = &program;
+        auto kept = bayeselo::parse_pgn_views(mixed, filtered_options);
+        std::size_t expected_kept = 0;
+        for (const auto& g : all.games) expected_kept += bayeselo::passes_filters(g, program) ? 1 : 0;
+        if (expected_kept != 3 || kept.games.size() != expected_kept) return fail("early rejection kept " + std::to_string(kept.games.size()) + " games, expected " + std::to_string(expected_kept));
+        if (kept.moves.games() != kept.games.size()) return fail("early rejection: kept moves out of step with games");
+        // Name verdicts are per player: bits depend only on the name, not on the colour it played.
+        if (program.name_matches("Stockfish 16") != bayeselo::FilterProgram::kEitherMatch || program.name_matches("Leela") != 0) return fail("name_matches bits wrong");
+        if (all.players.size() != 3) return fail("expected 3 distinct players in the unfiltered chunk");
+        bayeselo::FilterConfig lists;
+        lists.include_names = {"stockfish", "LEELA"};
+        lists.exclude_names = {"16"};
+        const bayeselo::FilterProgram list_program(lists);
+        bayeselo::ChunkFilter list_filter(all, list_program);
+        for (std::size_t i = 0; i < all.games.size(); ++i) {
+            if (list_filter.passes(i) != (all.games[i].white == "Leela")) return fail("include/exclude name lists applied wrongly");
+        }
+        bayeselo::ChunkFilter kept_filter(kept, program);
+        for (std::size_t i = 0; i < kept.games.size(); ++i) {
+            if (kept.games[i].white != "Stockfish 16" || kept.games[i].ply_count != 6 || !kept_filter.passes(i)) return fail("early rejection kept a wrong game");
+        }
+    }
+
+    // Stream reader cuts blocks at game starts and loses no bytes, even with blocks smaller than a game.
+    {
+        std::string stream_text;
+        for (int i = 0; i < 20; ++i) stream_text += annotated;
+        std::istringstream stream(stream_text);
+        bayeselo::PgnStreamReader reader(stream, 64);
+        std::string joined;
+        std::size_t stream_games = 0;
+        while (auto block = reader.next()) {
+            std::string_view text(block->data(), block->size());
+            if (!text.starts_with("[Event")) return fail("stream block does not start at a game");
+            stream_games += bayeselo::parse_pgn_text(text).size();
+            joined.append(text);
+        }
+        if (joined != stream_text) return fail("stream reader lost or reordered bytes");
+        if (stream_games != 20) return fail("stream reader: expected 20 games, got " + std::to_string(stream_games));
+
+        std::istringstream again(stream_text);
+        bayeselo::PgnStreamReader reuse_reader(again, 64);
+        std::vector<char> buffer;
+        std::string rejoined;
+        while (reuse_reader.next(buffer)) rejoined.append(buffer.data(), buffer.size());
+        if (rejoined != stream_text) return fail("stream reader into a reused buffer lost or reordered bytes");
+    }
+
+    // Raw byte-range chunks: every game is parsed exactly once whatever the chunk size, by both backends.
+    {
+        std::string many;
+        for (int i = 0; i < 30; ++i) many += annotated;
+        many += "[Event \"Tail\"]\n[White \"T\"]\n[Black \"U\"]\n\n1. d4 *"; // no trailing newline
+        {
+            std::ofstream f(chunk_path, std::ios::binary);
+            f << many;
+        }
+        auto many_mapping = bayeselo::MappedFile::open(chunk_path);
+        for (std::size_t chunk_bytes : {1u, 7u, 50u, 333u, 4096u}) {
+            for (bool use_mapping : {true, false}) {
+                std::size_t total_games = 0;
+                std::size_t total_plies = 0;
+                for (const auto& range : bayeselo::split_pgn_file(chunk_path, chunk_bytes)) {
+                    auto chunk = use_mapping ? bayeselo::parse_pgn_chunk_views(many_mapping, range.start_offset, range.end_offset)
+                                             : bayeselo::parse_pgn_chunk_views(range.file, range.start_offset, range.end_offset);
+                    if (!chunk) return fail("raw chunk parse failed");
+                    total_games += chunk->games.size();
+                    for (const auto& g : chunk->games) total_plies += g.ply_count;
+                }
+                if (total_games != 31 || total_plies != 30 * 8 + 1) {
+                    return fail("chunk size " + std::to_string(chunk_bytes) + (use_mapping ? " (mmap)" : " (stream)") + ": got " +
+                                std::to_string(total_games) + " games, " + std::to_string(total_plies) + " plies");
+                }
+            }
+        }
+    }
+
+    // Chunk size scales with input per worker and stays within its bounds.
+    if (bayeselo::choose_chunk_bytes(0, 8) != bayeselo::kMinChunkBytes) return fail("empty input should use the minimum chunk size");
+    if (bayeselo::choose_chunk_bytes(std::size_t{1} << 40, 8) != bayeselo::kMaxChunkBytes) return fail("huge input should use the maximum chunk size");
+    if (bayeselo::choose_chunk_bytes(std::size_t{512} << 20, 16) != (std::size_t{8} << 20)) return fail("512 MiB on 16 workers should use 8 MiB chunks");
+    if (bayeselo::choose_chunk_bytes(std::size_t{512} << 20, 0) != bayeselo::kMaxChunkBytes) return fail("zero workers should count as one");
+
+    // Block line scanner must agree with a byte-at-a-time reference on lines that straddle 64-byte blocks.
+    std::mt19937 rng(12345);
+    const std::string alphabet = " \t\r\n\n[ae1\v";
+    for (int round = 0; round < 200; ++round) {
+        std::string text(rng() % 300, ' ');
+        for (auto& ch : text) ch = alphabet[rng() % alphabet.size()];
+        std::vector<std::pair<std::string, bool>> expected;
+        std::size_t pos = 0;
+        while (pos < text.size()) {
+            std::size_t line_end = text.find('\n', pos);
+            if (line_end == std::string::npos) line_end = text.size();
+            std::string line = text.substr(pos, line_end - pos);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            const bool blank = std::all_of(line.begin(), line.end(), [](unsigned char ch) { return std::isspace(ch) != 0; });
+            expected.emplace_back(line, blank);
+            pos = line_end + 1;
+        }
+        std::vector<std::pair<std::string, bool>> got;
+        bayeselo::for_each_line(text, [&](std::string_view line, bool blank) { got.emplace_back(std::string(line), blank); });
+        if (got != expected) return fail("line scanner (" + std::string(bayeselo::line_scanner_backend()) + ") mismatch in round " + std::to_string(round));
+    }
+
     std::cout << "parser tests passed\n";
     return 0;
 }
@@ -0,0 +1,80 @@
+#include "util/task.h"
+#include "util/thread_pool.h"
+
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+int main() {
+    auto fail = [](const std::string& msg) {
+        std::cerr << msg << "\n";
+        return 1;
+    };
+
+    // Task: move-only captures, inline and heap storage.
+    {
+        int ran = 0;
+        bayeselo::Task small = [value = std::make_unique<int>(7), &ran]() { ran += *value; };
+        bayeselo::Task moved = std::move(small);
+        if (small) return fail("moved-from task should be empty");
+        moved();
+        std::array<int, 64> big{};
+        big.fill(1);
+        bayeselo::Task large = [big, &ran]() { ran += std::accumulate(big.begin(), big.end(), 0); };
+        bayeselo::Task other;
+        other = std::move(large);
+        other();
+        if (ran != 7 + 64) return fail("task calls gave " + std::to_string(ran));
+    }
+
+    for (std::size_t threads : {1u, 4u}) {
+        const std::string label = " with " + std::to_string(threads) + " threads";
+        bayeselo::ThreadPool pool(threads);
+
+        // Tasks enqueued from tasks land on the worker's own deque and are stolen by the others.
+        std::atomic_size_t leaves{0};
+        for (int i = 0; i < 8; ++i) {
+            pool.enqueue([&]() {
+                for (int j = 0; j < 100; ++j) {
+                    pool.enqueue([&]() { ++leaves; });
+                }
+            });
+        }
+        pool.wait_for_completion();
+        if (leaves != 800) return fail("nested enqueue ran " + std::to_string(leaves.load()) + " tasks" + label);
+
+        std::atomic_size_t bulk{0};
+        std::vector<bayeselo::Task> tasks;
+        for (int i = 0; i < 37; ++i) {
+            tasks.emplace_back([&bulk, i]() { bulk += static_cast<std::size_t>(i); });
+        }
+        pool.enqueue_bulk(std::move(tasks));
+        pool.wait_for_completion();
+        if (bulk != 666) return fail("enqueue_bulk sum " + std::to_string(bulk.load()) + label);
+
+        // Every index exactly once, also when the range is queued from inside a task.
+        std::vector<std::atomic_int> hits(1000);
+        pool.enqueue_range(0, hits.size(), 7, [&](std::size_t i) { ++hits[i]; });
+        pool.wait_for_completion();
+        for (std::size_t i = 0; i < hits.size(); ++i) {
+            if (hits[i] != 1) return fail("enqueue_range ran index " + std::to_string(i) + " " + std::to_string(hits[i].load()) + " times" + label);
+        }
+        std::atomic_size_t inner{0};
+        pool.enqueue([&]() { pool.enqueue_range(10, 110, 1, [&](std::size_t) { ++inner; }); });
+        pool.enqueue_range(0, 50, 4, [&](std::size_t) { ++inner; });
+        pool.enqueue_range(5, 5, 1, [&](std::size_t) { ++inner; });
+        pool.wait_for_completion();
+        if (inner != 150) return fail("nested enqueue_range ran " + std::to_string(inner.load()) + " indices" + label);
+
+        pool.shutdown();
+        pool.enqueue([&]() { ++inner; });
+        if (inner != 150) return fail("enqueue after shutdown should be dropped" + label);
+    }
+
+    std::cout << "thread pool tests passed\n";
+    return 0;
+}